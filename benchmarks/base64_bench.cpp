@@ -0,0 +1,165 @@
+// Encode and decode throughput of each base64 kernel available on this
+// CPU, after checking its output against OpenSSL and the scalar kernel.
+//
+//   base64_bench [megabytes]   (default 4; configure with -DCMAKE_BUILD_TYPE=Release)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include "base64.h"
+
+namespace {
+
+bool verify(const std::string& kernel) {
+    std::mt19937 random(42);
+    selectBase64Kernel("scalar");
+
+    for (size_t size = 0; size < 600; size++) {
+        std::string input(size, '\0');
+        for (char& c : input) {
+            c = static_cast<char>(random());
+        }
+
+        std::string expected(base64EncodedSize(size) + 1, '\0');
+        EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&expected[0]),
+                        reinterpret_cast<const unsigned char*>(input.data()),
+                        static_cast<int>(size));
+        expected.pop_back();
+
+        selectBase64Kernel(kernel);
+        std::string actual = base64Encode(input);
+        selectBase64Kernel("scalar");
+        if (actual != expected) {
+            std::cerr << kernel << ": wrong output for " << size << " bytes" << std::endl;
+            return false;
+        }
+
+        // Same input fed to the incremental encoder in random pieces
+        selectBase64Kernel(kernel);
+        Base64Encoder encoder;
+        std::string pieces(Base64Encoder::maxOutput(size) + 4, '\0');
+        size_t written = 0;
+        for (size_t at = 0; at < size;) {
+            size_t n = std::min<size_t>(random() % 70, size - at);
+            written += encoder.update(input.data() + at, n, &pieces[written]);
+            at += n;
+        }
+        written += encoder.finish(&pieces[written]);
+        pieces.resize(written);
+        selectBase64Kernel("scalar");
+        if (pieces != expected) {
+            std::cerr << kernel << ": wrong incremental output for " << size << " bytes"
+                      << std::endl;
+            return false;
+        }
+
+        // Decoding, plain and wrapped at 60 columns like the contents API
+        std::string wrapped;
+        for (size_t at = 0; at < expected.size(); at += 60) {
+            wrapped += expected.substr(at, 60) + "\n";
+        }
+        selectBase64Kernel(kernel);
+        std::string decoded;
+        std::string decodedWrapped;
+        bool plainOk = base64Decode(expected, decoded);
+        bool wrappedOk = base64Decode(wrapped, decodedWrapped);
+        selectBase64Kernel("scalar");
+        if (!plainOk || !wrappedOk || decoded != input || decodedWrapped != input) {
+            std::cerr << kernel << ": wrong decoding for " << size << " bytes" << std::endl;
+            return false;
+        }
+    }
+
+    // Every byte value in every block position must be judged like the
+    // scalar decoder judges it
+    for (int byte = 0; byte < 256; byte++) {
+        for (size_t at = 0; at < 64; at += 7) {
+            std::string text(128, 'A');
+            text[at] = static_cast<char>(byte);
+
+            std::string expected;
+            bool expectedOk = base64Decode(text, expected);
+            selectBase64Kernel(kernel);
+            std::string actual;
+            bool actualOk = base64Decode(text, actual);
+            selectBase64Kernel("scalar");
+            if (actualOk != expectedOk || actual != expected) {
+                std::cerr << kernel << ": wrong verdict on byte " << byte << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+double measureDecode(const std::vector<char>& input, std::vector<char>& output) {
+    const int rounds = 20;
+    double best = 0;
+    for (int round = 0; round < rounds; round++) {
+        auto start = std::chrono::steady_clock::now();
+        Base64Decoder decoder;
+        size_t written = 0;
+        decoder.update(input.data(), input.size(), output.data(), written);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::max(best, input.size() / elapsed.count() / 1e9);
+    }
+    return best;
+}
+
+double measure(const std::vector<unsigned char>& input, std::vector<char>& output) {
+    const int rounds = 20;
+    double best = 0;
+    for (int round = 0; round < rounds; round++) {
+        auto start = std::chrono::steady_clock::now();
+        base64Encode(input.data(), input.size(), output.data());
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::max(best, input.size() / elapsed.count() / 1e9);
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    std::vector<unsigned char> input(megabytes * 1024 * 1024);
+    std::mt19937 random(7);
+    for (unsigned char& byte : input) {
+        byte = static_cast<unsigned char>(random());
+    }
+    std::vector<char> output(base64EncodedSize(input.size()));
+    std::vector<char> decodeOutput(input.size());
+
+    bool ok = true;
+    for (const std::string& kernel : base64Kernels()) {
+        if (!verify(kernel)) {
+            ok = false;
+            continue;
+        }
+        selectBase64Kernel(kernel);
+        double encode = measure(input, output);
+        std::vector<char> wrapped;
+        for (size_t at = 0; at < output.size(); at += 60) {
+            size_t n = std::min<size_t>(60, output.size() - at);
+            wrapped.insert(wrapped.end(), output.begin() + at, output.begin() + at + n);
+            wrapped.push_back('\n');
+        }
+        std::cout << kernel << ": encode " << encode << " GB/s, decode "
+                  << measureDecode(output, decodeOutput) << " GB/s, decode wrapped "
+                  << measureDecode(wrapped, decodeOutput) << " GB/s" << std::endl;
+    }
+
+    // Baseline for comparison
+    std::vector<unsigned char> evpOutput(output.size() + 1);
+    auto start = std::chrono::steady_clock::now();
+    EVP_EncodeBlock(evpOutput.data(), input.data(), static_cast<int>(input.size()));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "openssl: encode " << input.size() / elapsed.count() / 1e9 << " GB/s" << std::endl;
+
+    return ok ? 0 : 1;
+}
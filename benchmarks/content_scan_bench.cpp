@@ -0,0 +1,160 @@
+// Throughput of each content scan kernel available on this CPU, after
+// checking it against known UTF-8 cases and the scalar kernel. memcpy over
+// the same buffer is the memory bandwidth baseline.
+//
+//   content_scan_bench [megabytes]   (default 64; configure with -DCMAKE_BUILD_TYPE=Release)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "content_scan.h"
+
+namespace {
+
+ContentProfile scanPieces(const std::string& text, std::mt19937& random) {
+    ContentScanner scanner;
+    for (size_t at = 0; at < text.size();) {
+        size_t n = std::min<size_t>(random() % 150, text.size() - at);
+        scanner.update(text.data() + at, n);
+        at += n;
+    }
+    return scanner.finish();
+}
+
+bool same(const ContentProfile& a, const ContentProfile& b) {
+    return a.size == b.size && a.hasNul == b.hasNul && a.validUtf8 == b.validUtf8 &&
+           a.crlfLines == b.crlfLines && a.lfLines == b.lfLines;
+}
+
+// Text built from whole characters, then damaged in a few places
+std::string sample(std::mt19937& random) {
+    static const char* const kPieces[] = {
+        "a", "Z", " ", "\n", "\r\n", "\r", "\t", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+        "\xed\x9f\xbf", "\xee\x80\x80", "\xf4\x8f\xbf\xbf", "\xe0\xa0\x80", "\xf0\x90\x80\x80",
+    };
+    std::string text;
+    size_t pieces = random() % 300;
+    for (size_t i = 0; i < pieces; i++) {
+        text += kPieces[random() % (sizeof(kPieces) / sizeof(kPieces[0]))];
+    }
+    int damage = random() % 4 == 0 ? 1 + random() % 3 : 0;
+    for (int i = 0; i < damage && !text.empty(); i++) {
+        text[random() % text.size()] = static_cast<char>(random());
+    }
+    if (random() % 8 == 0 && !text.empty()) {
+        text.pop_back();   // may cut a sequence short
+    }
+    return text;
+}
+
+bool verify(const std::string& kernel) {
+    struct Case {
+        const char* text;
+        size_t size;
+        bool valid;
+    };
+    static const Case kCases[] = {
+        {"plain ascii", 11, true},
+        {"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", 9, true},
+        {"\xc0\x80", 2, false},               // overlong NUL
+        {"\xe0\x80\xaf", 3, false},           // overlong '/'
+        {"\xed\xa0\x80", 3, false},           // surrogate
+        {"\xf4\x90\x80\x80", 4, false},       // above U+10FFFF
+        {"\xf5\x80\x80\x80", 4, false},
+        {"\xe2\x82", 2, false},               // cut short
+        {"\x80", 1, false},                   // stray continuation
+        {"\xc3\xa9\xa9", 3, false},
+    };
+
+    std::mt19937 random(11);
+    for (const Case& c : kCases) {
+        // At every offset within a block, so both kernels see block edges
+        for (size_t pad = 0; pad < 70; pad++) {
+            std::string text = std::string(pad, 'x') + std::string(c.text, c.size);
+            selectContentScanKernel(kernel);
+            ContentProfile profile = scanPieces(text, random);
+            if (profile.validUtf8 != c.valid) {
+                std::cerr << kernel << ": wrong verdict on case " << (&c - kCases) << " at offset "
+                          << pad << std::endl;
+                return false;
+            }
+        }
+    }
+
+    for (int round = 0; round < 20000; round++) {
+        std::string text = sample(random);
+        selectContentScanKernel("scalar");
+        ContentProfile expected = scanPieces(text, random);
+        selectContentScanKernel(kernel);
+        ContentProfile actual = scanPieces(text, random);
+        if (!same(expected, actual)) {
+            std::cerr << kernel << ": disagrees with scalar on a " << text.size()
+                      << " byte sample" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Body>
+double measure(size_t size, Body body) {
+    double best = 0;
+    for (int round = 0; round < 10; round++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::max(best, size / elapsed.count() / 1e9);
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+
+    // Source-like text: mostly ASCII, some accents, CRLF line ends
+    std::string text;
+    std::mt19937 random(5);
+    while (text.size() < megabytes * 1024 * 1024) {
+        size_t length = random() % 100;
+        for (size_t i = 0; i < length; i++) {
+            text += static_cast<char>(' ' + random() % 95);
+        }
+        if (random() % 10 == 0) {
+            text += "\xc3\xa9";
+        }
+        text += "\r\n";
+    }
+    std::vector<char> copy(text.size());
+
+    bool ok = true;
+    for (const std::string& kernel : contentScanKernels()) {
+        if (!verify(kernel)) {
+            ok = false;
+            continue;
+        }
+        selectContentScanKernel(kernel);
+        double rate = measure(text.size(), [&]() {
+            ContentScanner scanner;
+            scanner.update(text.data(), text.size());
+            ContentProfile profile = scanner.finish();
+            if (profile.binary()) {
+                std::cerr << kernel << ": sample text judged binary" << std::endl;
+            }
+        });
+        std::cout << kernel << ": " << rate << " GB/s" << std::endl;
+    }
+
+    double bandwidth = measure(text.size(), [&]() {
+        std::memcpy(copy.data(), text.data(), text.size());
+    });
+    std::cout << "memcpy: " << bandwidth << " GB/s" << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// Time to list the regular files under a directory with the parallel walker
+// at several thread counts, after checking it finds the same files as
+// std::filesystem::recursive_directory_iterator, which is the baseline.
+// Without a directory argument a synthetic tree is built in /tmp first.
+//
+//   dir_walk_bench [directory | file count]   (default 500000 files)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dir_walker.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 20 files per directory, 8 subdirectories per directory, so a mix of
+// wide and deep like a source checkout
+void buildTree(const fs::path& root, size_t files) {
+    std::vector<fs::path> directories{root};
+    fs::create_directories(root);
+    size_t made = 0;
+    for (size_t next = 0; made < files; next++) {
+        fs::path directory = directories[next];
+        for (int i = 0; i < 20 && made < files; i++, made++) {
+            std::ofstream(directory / ("file" + std::to_string(i) + ".c")) << made;
+        }
+        for (int i = 0; i < 8 && directories.size() * 20 < files; i++) {
+            directories.push_back(directory / ("dir" + std::to_string(i)));
+            fs::create_directory(directories.back());
+        }
+    }
+}
+
+std::vector<std::string> iteratorListing(const std::string& root) {
+    std::vector<std::string> paths;
+    for (fs::recursive_directory_iterator it(root), end; it != end; ++it) {
+        if (it->path().filename() == ".git") {
+            it.disable_recursion_pending();
+        } else if (it->is_regular_file()) {
+            paths.push_back(fs::relative(it->path(), root).generic_string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+template <typename Body>
+double seconds(Body body) {
+    double best = 1e9;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string root;
+    bool built = false;
+    if (argc > 1 && fs::is_directory(argv[1])) {
+        root = argv[1];
+    } else {
+        size_t files = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+        root = (fs::temp_directory_path() / "dir_walk_bench").string();
+        fs::remove_all(root);
+        buildTree(root, files);
+        built = true;
+    }
+
+    std::vector<std::string> expected = iteratorListing(root);
+    FileList list;
+    DirectoryWalker check;
+    check.walk(root, list);
+    bool ok = list.size() == expected.size();
+    for (size_t i = 0; ok && i < list.size(); i++) {
+        ok = list.path(i) == expected[i];
+    }
+    if (!ok) {
+        std::cerr << "walker and iterator disagree (" << list.size() << " vs " << expected.size()
+                  << " files)" << std::endl;
+    }
+    std::cout << expected.size() << " files in " << check.directoriesRead() << " directories"
+              << std::endl;
+
+    double baseline = seconds([&]() { iteratorListing(root); });
+    std::cout << "recursive_directory_iterator: " << baseline << " s" << std::endl;
+    for (unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+        DirectoryWalker walker(threads);
+        double time = seconds([&]() { walker.walk(root, list); });
+        std::cout << "walker, " << threads << " threads: " << time << " s" << std::endl;
+    }
+
+    if (built) {
+        fs::remove_all(root);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// Throughput of each batch SHA-1 kernel available on this CPU on many
+// small messages, after checking its digests against OpenSSL. OpenSSL's
+// EVP one-shot, one message at a time, is the baseline.
+//
+//   sha1_bench [message bytes] [messages]   (default 4096 x 4096)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include "sha1_batch.h"
+
+namespace {
+
+void evpSha1(const std::string& message, unsigned char* digest) {
+    unsigned int length = 0;
+    EVP_Digest(message.data(), message.size(), digest, &length, EVP_sha1(), nullptr);
+}
+
+bool verify(const std::string& kernel) {
+    std::mt19937 random(42);
+    std::vector<std::string> prefixes;
+    std::vector<std::string> bodies;
+    for (size_t i = 0; i < 700; i++) {
+        // Sizes around every block boundary, plus a few multi-block ones
+        size_t size = i < 300 ? i : random() % 20000;
+        std::string body(size, '\0');
+        for (char& c : body) {
+            c = static_cast<char>(random());
+        }
+        prefixes.push_back(i % 3 == 0 ? "" : "blob " + std::to_string(size) + std::string(1, '\0'));
+        bodies.push_back(body);
+    }
+
+    std::vector<Sha1Job> jobs(bodies.size());
+    for (size_t i = 0; i < jobs.size(); i++) {
+        jobs[i].prefix = prefixes[i].data();
+        jobs[i].prefixSize = prefixes[i].size();
+        jobs[i].data = bodies[i].data();
+        jobs[i].size = bodies[i].size();
+    }
+    selectSha1Kernel(kernel);
+    sha1Batch(jobs.data(), jobs.size());
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        unsigned char expected[EVP_MAX_MD_SIZE];
+        evpSha1(prefixes[i] + bodies[i], expected);
+        if (std::memcmp(expected, jobs[i].digest, 20) != 0) {
+            std::cerr << kernel << ": wrong digest for message " << i << " ("
+                      << prefixes[i].size() + bodies[i].size() << " bytes)" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t messageSize = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    size_t messageCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4096;
+
+    std::vector<std::string> messages(messageCount);
+    std::mt19937 random(7);
+    for (std::string& message : messages) {
+        message.resize(messageSize);
+        for (char& c : message) {
+            c = static_cast<char>(random());
+        }
+    }
+    std::vector<Sha1Job> jobs(messageCount);
+    for (size_t i = 0; i < messageCount; i++) {
+        jobs[i].data = messages[i].data();
+        jobs[i].size = messages[i].size();
+    }
+    double bytes = static_cast<double>(messageSize) * messageCount;
+
+    bool ok = true;
+    for (const std::string& kernel : sha1Kernels()) {
+        if (!verify(kernel)) {
+            ok = false;
+            continue;
+        }
+        selectSha1Kernel(kernel);
+        double best = 0;
+        for (int round = 0; round < 5; round++) {
+            auto start = std::chrono::steady_clock::now();
+            sha1Batch(jobs.data(), jobs.size());
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::max(best, bytes / elapsed.count() / 1e9);
+        }
+        std::cout << kernel << ": " << best << " GB/s" << std::endl;
+    }
+
+    double best = 0;
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& message : messages) {
+            evpSha1(message, digest);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::max(best, bytes / elapsed.count() / 1e9);
+    }
+    std::cout << "openssl: " << best << " GB/s" << std::endl;
+
+    return ok ? 0 : 1;
+}
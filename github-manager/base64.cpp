@@ -0,0 +1,592 @@
+#include "base64.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GITHUB_MANAGER_BASE64_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// A kernel encodes whole blocks from the front of the input and returns how
+// many input bytes it consumed (a multiple of 3). The scalar tail handles
+// the rest, including the padding.
+typedef size_t (*EncodeKernel)(const unsigned char* input, size_t size, char* output);
+
+// Decodes whole blocks of alphabet characters from the front of the input
+// and returns how many characters it consumed (a multiple of 4). It stops
+// at the first block holding anything else (whitespace, padding, garbage),
+// which the scalar decoder then deals with.
+typedef size_t (*DecodeKernel)(const char* input, size_t size, char* output);
+
+struct Kernel {
+    const char* name;
+    EncodeKernel encode;
+    DecodeKernel decode;
+    bool (*supported)();
+};
+
+const signed char kInvalid = -1;
+const signed char kSpace = -2;
+const signed char kPad = -3;
+
+// Character -> 6-bit value, or one of the markers above
+struct DecodeTable {
+    signed char value[256];
+
+    DecodeTable() {
+        for (int i = 0; i < 256; i++) {
+            value[i] = kInvalid;
+        }
+        for (int i = 0; i < 64; i++) {
+            value[static_cast<unsigned char>(kAlphabet[i])] = static_cast<signed char>(i);
+        }
+        value[static_cast<unsigned char>(' ')] = kSpace;
+        value[static_cast<unsigned char>('\t')] = kSpace;
+        value[static_cast<unsigned char>('\r')] = kSpace;
+        value[static_cast<unsigned char>('\n')] = kSpace;
+        value[static_cast<unsigned char>('=')] = kPad;
+    }
+};
+
+const DecodeTable kDecode;
+
+size_t decodeScalar(const char* input, size_t size, char* output) {
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        int a = kDecode.value[static_cast<unsigned char>(input[i])];
+        int b = kDecode.value[static_cast<unsigned char>(input[i + 1])];
+        int c = kDecode.value[static_cast<unsigned char>(input[i + 2])];
+        int d = kDecode.value[static_cast<unsigned char>(input[i + 3])];
+        if ((a | b | c | d) < 0) {
+            break;
+        }
+        unsigned int word = (a << 18) | (b << 12) | (c << 6) | d;
+        *output++ = static_cast<char>(word >> 16);
+        *output++ = static_cast<char>(word >> 8);
+        *output++ = static_cast<char>(word);
+    }
+    return i;
+}
+
+size_t encodeScalar(const unsigned char* input, size_t size, char* output) {
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        unsigned int word = (input[i] << 16) | (input[i + 1] << 8) | input[i + 2];
+        *output++ = kAlphabet[(word >> 18) & 0x3f];
+        *output++ = kAlphabet[(word >> 12) & 0x3f];
+        *output++ = kAlphabet[(word >> 6) & 0x3f];
+        *output++ = kAlphabet[word & 0x3f];
+    }
+    return i;
+}
+
+void encodeTail(const unsigned char* input, size_t size, char* output) {
+    if (size == 1) {
+        output[0] = kAlphabet[input[0] >> 2];
+        output[1] = kAlphabet[(input[0] & 0x03) << 4];
+        output[2] = '=';
+        output[3] = '=';
+    } else if (size == 2) {
+        output[0] = kAlphabet[input[0] >> 2];
+        output[1] = kAlphabet[((input[0] & 0x03) << 4) | (input[1] >> 4)];
+        output[2] = kAlphabet[(input[1] & 0x0f) << 2];
+        output[3] = '=';
+    }
+}
+
+bool always() {
+    return true;
+}
+
+#ifdef GITHUB_MANAGER_BASE64_X86
+
+// The SSSE3 and AVX2 kernels follow Mula and Lemire, "Faster Base64
+// Encoding and Decoding using AVX2 Instructions": spread each 3-byte group
+// over 4 bytes, isolate the 6-bit fields with two multiplies, then map the
+// indices to ASCII with a 16-entry offset table.
+
+__attribute__((target("ssse3")))
+__m128i splitSSSE3(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("ssse3")))
+__m128i translateSSSE3(__m128i indices) {
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+    __m128i slot = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    slot = _mm_or_si128(slot, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, slot), indices);
+}
+
+__attribute__((target("ssse3")))
+size_t encodeSSSE3(const unsigned char* input, size_t size, char* output) {
+    size_t i = 0;
+    // Each step reads 16 bytes but consumes only 12
+    for (; i + 16 <= size; i += 12) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m128i out = translateSSSE3(splitSSSE3(in));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), out);
+        output += 16;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t encodeAVX2(const unsigned char* input, size_t size, char* output) {
+    const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                            10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i offsets = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    size_t i = 0;
+    // Each step reads 28 bytes but consumes only 24
+    for (; i + 28 <= size; i += 24) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        in = _mm256_shuffle_epi8(in, shuffle);
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i slot = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        slot = _mm256_or_si256(slot, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+        __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, slot), indices);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), out);
+        output += 32;
+    }
+    return i;
+}
+
+// AVX-512 VBMI does the whole job with three instructions: a byte permute
+// to gather each group's bytes, a multishift to pull out the 6-bit fields,
+// and a second permute through the 64-character alphabet.
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+size_t encodeAVX512VBMI(const unsigned char* input, size_t size, char* output) {
+    const __m512i gather = _mm512_setr_epi32(
+        0x01020001, 0x04050304, 0x07080607, 0x0a0b090a, 0x0d0e0c0d, 0x10110f10,
+        0x13141213, 0x16171516, 0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122,
+        0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e);
+    const __m512i shifts = _mm512_set1_epi64(0x3036242a1016040aLL);
+    const __m512i alphabet = _mm512_loadu_si512(kAlphabet);
+
+    size_t i = 0;
+    // Each step reads 64 bytes but consumes only 48
+    for (; i + 64 <= size; i += 48) {
+        __m512i in = _mm512_loadu_si512(input + i);
+        in = _mm512_permutexvar_epi8(gather, in);
+        const __m512i indices = _mm512_multishift_epi64_epi8(shifts, in);
+        _mm512_storeu_si512(output, _mm512_permutexvar_epi8(indices, alphabet));
+        output += 64;
+    }
+    return i;
+}
+
+// Decoding follows the same paper: classify each character by its nibbles
+// to validate it and to pick the offset that maps it to its 6-bit value,
+// then pack four 6-bit values into three bytes with two multiply-adds.
+
+__attribute__((target("ssse3")))
+size_t decodeSSSE3(const char* input, size_t size, char* output) {
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                          0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+        const __m128i lo = _mm_shuffle_epi8(lutLo, _mm_and_si128(in, mask2F));
+        const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) ||
+            _mm_movemask_epi8(in)) {
+            break;
+        }
+        const __m128i eq2F = _mm_cmpeq_epi8(in, mask2F);
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+        in = _mm_add_epi8(in, roll);
+
+        const __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140)),
+                                              _mm_set1_epi32(0x00011000));
+        const __m128i out = _mm_shuffle_epi8(merged, pack);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output), out);
+        int last = _mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+        std::memcpy(output + 8, &last, 4);
+        output += 12;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t decodeAVX2(const char* input, size_t size, char* output) {
+    const __m256i lutLo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m256i lutHi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask2F = _mm256_set1_epi8(0x2f);
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask2F);
+        const __m256i lo = _mm256_shuffle_epi8(lutLo, _mm256_and_si256(in, mask2F));
+        const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        if (!_mm256_testz_si256(lo, hi) || _mm256_movemask_epi8(in)) {
+            break;
+        }
+        const __m256i eq2F = _mm256_cmpeq_epi8(in, mask2F);
+        const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+        in = _mm256_add_epi8(in, roll);
+
+        const __m256i merged = _mm256_madd_epi16(
+            _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+        const __m256i out = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, pack),
+                                                        _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm256_castsi256_si128(out));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 16), _mm256_extracti128_si256(out, 1));
+        output += 24;
+    }
+    return i;
+}
+
+// VBMI translates all 64 characters with one two-table byte permute; any
+// character outside the alphabet comes out with its top bit set.
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+size_t decodeAVX512VBMI(const char* input, size_t size, char* output) {
+    struct Tables {
+        signed char lookup[128];
+        char pack[64];
+
+        Tables() {
+            for (int i = 0; i < 128; i++) {
+                lookup[i] = kDecode.value[i] >= 0 ? kDecode.value[i] : static_cast<signed char>(0x80);
+            }
+            // Each 32-bit lane holds one decoded group, lowest byte last
+            for (int j = 0; j < 64; j++) {
+                pack[j] = static_cast<char>(j < 48 ? 4 * (j / 3) + 2 - j % 3 : 0);
+            }
+        }
+    };
+    static const Tables tables;
+
+    const __m512i lookupLo = _mm512_loadu_si512(tables.lookup);
+    const __m512i lookupHi = _mm512_loadu_si512(tables.lookup + 64);
+    const __m512i pack = _mm512_loadu_si512(tables.pack);
+
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m512i in = _mm512_loadu_si512(input + i);
+        const __m512i values = _mm512_permutex2var_epi8(lookupLo, in, lookupHi);
+        if (_mm512_movepi8_mask(_mm512_or_si512(values, in))) {
+            break;
+        }
+        const __m512i merged = _mm512_madd_epi16(
+            _mm512_maddubs_epi16(values, _mm512_set1_epi32(0x01400140)), _mm512_set1_epi32(0x00011000));
+        _mm512_mask_storeu_epi8(output, 0xffffffffffffULL, _mm512_permutexvar_epi8(pack, merged));
+        output += 48;
+    }
+    return i;
+}
+
+bool hasSSSE3() {
+    return __builtin_cpu_supports("ssse3");
+}
+
+bool hasAVX2() {
+    return __builtin_cpu_supports("avx2");
+}
+
+bool hasAVX512VBMI() {
+    return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi");
+}
+
+#endif
+
+const Kernel kKernels[] = {
+    {"scalar", encodeScalar, decodeScalar, always},
+#ifdef GITHUB_MANAGER_BASE64_X86
+    {"ssse3", encodeSSSE3, decodeSSSE3, hasSSSE3},
+    {"avx2", encodeAVX2, decodeAVX2, hasAVX2},
+    {"avx512vbmi", encodeAVX512VBMI, decodeAVX512VBMI, hasAVX512VBMI},
+#endif
+};
+
+const Kernel* findKernel(const std::string& name) {
+    for (const Kernel& kernel : kKernels) {
+        if (name == kernel.name && kernel.supported()) {
+            return &kernel;
+        }
+    }
+    return nullptr;
+}
+
+const Kernel* bestKernel() {
+    const char* forced = std::getenv("GITHUB_MANAGER_BASE64");
+    if (forced) {
+        const Kernel* kernel = findKernel(forced);
+        if (kernel) {
+            return kernel;
+        }
+    }
+
+    const Kernel* best = &kKernels[0];
+    for (const Kernel& kernel : kKernels) {
+        if (kernel.supported()) {
+            best = &kernel;
+        }
+    }
+    return best;
+}
+
+std::atomic<const Kernel*> selected{nullptr};
+
+const Kernel* activeKernel() {
+    const Kernel* kernel = selected.load(std::memory_order_acquire);
+    if (!kernel) {
+        kernel = bestKernel();
+        selected.store(kernel, std::memory_order_release);
+    }
+    return kernel;
+}
+
+}
+
+void base64Encode(const void* input, size_t size, char* output) {
+    const unsigned char* in = static_cast<const unsigned char*>(input);
+
+    size_t done = activeKernel()->encode(in, size, output);
+    done += encodeScalar(in + done, size - done, output + done / 3 * 4);
+    encodeTail(in + done, size - done, output + done / 3 * 4);
+}
+
+std::string base64Encode(const std::string& input) {
+    std::string result(base64EncodedSize(input.size()), '\0');
+    base64Encode(input.data(), input.size(), &result[0]);
+    return result;
+}
+
+size_t Base64Encoder::update(const void* input, size_t size, char* output) {
+    const unsigned char* in = static_cast<const unsigned char*>(input);
+    size_t written = 0;
+
+    // Complete the group left over from the previous piece first
+    if (carried > 0) {
+        while (carried < 3 && size > 0) {
+            carry[carried++] = *in++;
+            size--;
+        }
+        if (carried < 3) {
+            return 0;
+        }
+        base64Encode(carry, 3, output);
+        output += 4;
+        written += 4;
+        carried = 0;
+    }
+
+    size_t whole = size - size % 3;
+    base64Encode(in, whole, output);
+    written += base64EncodedSize(whole);
+
+    for (size_t i = whole; i < size; i++) {
+        carry[carried++] = in[i];
+    }
+    return written;
+}
+
+size_t Base64Encoder::finish(char* output) {
+    if (carried == 0) {
+        return 0;
+    }
+    base64Encode(carry, carried, output);
+    carried = 0;
+    return 4;
+}
+
+bool Base64Decoder::update(const char* input, size_t size, char* output, size_t& written) {
+    written = 0;
+
+    // Line breaks would stop the kernels at every line, so wrapped input
+    // is compacted a window at a time before decoding
+    while (size > 0 && !failed) {
+        if (!std::memchr(input, '\n', size)) {
+            size_t n = 0;
+            decode(input, size, output + written, n);
+            written += n;
+            break;
+        }
+
+        stage.resize(kStageSize);
+        size_t staged = 0;
+        while (size > 0 && staged < kStageSize) {
+            size_t n = std::min(size, kStageSize - staged);
+            const char* newline = static_cast<const char*>(std::memchr(input, '\n', n));
+            size_t run = newline ? static_cast<size_t>(newline - input) : n;
+            std::memcpy(&stage[staged], input, run);
+            staged += run;
+            size_t skipped = newline ? run + 1 : run;
+            input += skipped;
+            size -= skipped;
+        }
+
+        size_t n = 0;
+        decode(stage.data(), staged, output + written, n);
+        written += n;
+    }
+    return !failed;
+}
+
+void Base64Decoder::decode(const char* input, size_t size, char* output, size_t& written) {
+    written = 0;
+    DecodeKernel kernel = activeKernel()->decode;
+
+    size_t i = 0;
+    while (i < size && !failed) {
+        // Between groups, let the kernel take every clean block it can
+        if (count == 0 && !ended) {
+            size_t consumed = kernel(input + i, size - i, output + written);
+            i += consumed;
+            written += consumed / 4 * 3;
+        }
+
+        // Then step through characters until the next group boundary
+        do {
+            if (i >= size) {
+                break;
+            }
+            signed char value = kDecode.value[static_cast<unsigned char>(input[i++])];
+            if (value == kSpace) {
+                continue;
+            }
+            if (value == kPad) {
+                // "xx==" or "xxx=" ends the data; more padding may follow
+                if (!ended) {
+                    if (count < 2) {
+                        failed = true;
+                        break;
+                    }
+                    written += flush(output + written);
+                    ended = true;
+                }
+                continue;
+            }
+            if (value == kInvalid || ended) {
+                failed = true;
+                break;
+            }
+            bits = (bits << 6) | static_cast<unsigned int>(value);
+            if (++count == 4) {
+                output[written++] = static_cast<char>(bits >> 16);
+                output[written++] = static_cast<char>(bits >> 8);
+                output[written++] = static_cast<char>(bits);
+                bits = 0;
+                count = 0;
+            }
+        } while (count != 0);
+    }
+}
+
+size_t Base64Decoder::flush(char* output) {
+    size_t written = 0;
+    if (count == 2) {
+        output[written++] = static_cast<char>(bits >> 4);
+    } else if (count == 3) {
+        output[written++] = static_cast<char>(bits >> 10);
+        output[written++] = static_cast<char>(bits >> 2);
+    }
+    bits = 0;
+    count = 0;
+    return written;
+}
+
+bool Base64Decoder::finish(char* output, size_t& written) {
+    written = 0;
+    // Unpadded input may stop after 2 or 3 characters of a group
+    if (failed || count == 1) {
+        return false;
+    }
+    written = flush(output);
+    return true;
+}
+
+void Base64Decoder::reset() {
+    bits = 0;
+    count = 0;
+    ended = false;
+    failed = false;
+}
+
+bool base64Decode(const std::string& input, std::string& output) {
+    Base64Decoder decoder;
+    output.resize(Base64Decoder::maxOutput(input.size()));
+    size_t written = 0;
+    size_t tail = 0;
+    if (!decoder.update(input.data(), input.size(), &output[0], written) ||
+        !decoder.finish(&output[written], tail)) {
+        output.clear();
+        return false;
+    }
+    output.resize(written + tail);
+    return true;
+}
+
+const char* base64KernelName() {
+    return activeKernel()->name;
+}
+
+std::vector<std::string> base64Kernels() {
+    std::vector<std::string> names;
+    for (const Kernel& kernel : kKernels) {
+        if (kernel.supported()) {
+            names.push_back(kernel.name);
+        }
+    }
+    return names;
+}
+
+bool selectBase64Kernel(const std::string& name) {
+    const Kernel* kernel = findKernel(name);
+    if (!kernel) {
+        return false;
+    }
+    selected.store(kernel, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,92 @@
+#ifndef GITHUB_MANAGER_BASE64_H
+#define GITHUB_MANAGER_BASE64_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Standard base64 (RFC 4648). The encoder writes padded output without line
+// breaks; the decoder accepts padded or unpadded input with whitespace
+// anywhere, as the contents API wraps its base64 every 60 characters.
+//
+// Both directions have scalar, SSSE3, AVX2 and AVX-512 VBMI kernels. The
+// fastest one the CPU supports is picked on first use;
+// GITHUB_MANAGER_BASE64=<name> in the environment overrides the choice.
+
+// Exact number of characters base64Encode writes for size input bytes.
+inline size_t base64EncodedSize(size_t size) {
+    return (size + 2) / 3 * 4;
+}
+
+// Encodes size bytes from input into output, which must have room for
+// base64EncodedSize(size) characters. No terminating NUL is written.
+void base64Encode(const void* input, size_t size, char* output);
+
+std::string base64Encode(const std::string& input);
+
+// Encodes a stream that arrives in pieces, e.g. from a file reader or a
+// network read callback. Up to 2 bytes that do not fill a 3-byte group are
+// carried over to the next piece, so the pieces may have any size and the
+// output is identical to encoding everything at once.
+class Base64Encoder {
+public:
+    // Largest number of characters update() writes for size input bytes.
+    static size_t maxOutput(size_t size) { return (size + 2) / 3 * 4; }
+
+    // Encodes the next size bytes into output and returns the characters
+    // written. output must have room for maxOutput(size).
+    size_t update(const void* input, size_t size, char* output);
+
+    // Flushes the carried bytes with padding; writes at most 4 characters.
+    size_t finish(char* output);
+
+    void reset() { carried = 0; }
+
+private:
+    unsigned char carry[3];
+    size_t carried = 0;
+};
+
+// Decodes a stream that arrives in pieces of any size; a group split
+// between pieces is carried over. Whitespace is skipped.
+class Base64Decoder {
+public:
+    // Largest number of bytes update() writes for size input characters.
+    static size_t maxOutput(size_t size) { return (size + 3) / 4 * 3; }
+
+    // Decodes the next size characters into output, which must have room
+    // for maxOutput(size), and sets written. False on invalid input.
+    bool update(const char* input, size_t size, char* output, size_t& written);
+
+    // Ends the stream, writing at most 2 bytes for an unpadded last group.
+    // False if the input was invalid or stopped mid-group.
+    bool finish(char* output, size_t& written);
+
+    void reset();
+
+private:
+    static const size_t kStageSize = 16 * 1024;
+
+    void decode(const char* input, size_t size, char* output, size_t& written);
+    size_t flush(char* output);
+
+    std::vector<char> stage;   // wrapped input with the line breaks removed
+    unsigned int bits = 0;
+    int count = 0;
+    bool ended = false;    // padding seen
+    bool failed = false;
+};
+
+// Decodes all of input; false (with output cleared) if it is not base64.
+bool base64Decode(const std::string& input, std::string& output);
+
+// Name of the kernel in use ("scalar", "ssse3", "avx2", "avx512vbmi").
+const char* base64KernelName();
+
+// Kernels usable on this CPU, slowest first.
+std::vector<std::string> base64Kernels();
+
+// Switches to the named kernel; false if it is unknown or unsupported.
+bool selectBase64Kernel(const std::string& name);
+
+#endif
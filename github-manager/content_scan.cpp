@@ -0,0 +1,440 @@
+#include "content_scan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include "file_source.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GITHUB_MANAGER_CONTENT_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const size_t kBlock = ContentScanner::kBlockSize;
+
+// Scans count whole blocks. tail holds the last 3 bytes before the first
+// block on entry, which is all the context UTF-8 validation and CRLF
+// detection need, and is updated on return.
+typedef void (*ScanKernel)(const unsigned char* blocks, size_t count, ContentProfile& profile,
+                           unsigned char* tail);
+
+struct Kernel {
+    const char* name;
+    ScanKernel scan;
+    bool (*supported)();
+};
+
+bool always() {
+    return true;
+}
+
+// Sequence length announced by a lead byte; 0 for anything else
+inline int leadLength(unsigned char c) {
+    if (c >= 0xc2 && c <= 0xdf) {
+        return 2;
+    }
+    if (c >= 0xe0 && c <= 0xef) {
+        return 3;
+    }
+    if (c >= 0xf0 && c <= 0xf4) {
+        return 4;
+    }
+    return 0;
+}
+
+// Allowed range for the byte after a lead; only some leads narrow it
+inline void secondByteRange(unsigned char lead, unsigned char& low, unsigned char& high) {
+    low = 0x80;
+    high = 0xbf;
+    if (lead == 0xe0) {
+        low = 0xa0;          // overlong
+    } else if (lead == 0xed) {
+        high = 0x9f;         // surrogates
+    } else if (lead == 0xf0) {
+        low = 0x90;          // overlong
+    } else if (lead == 0xf4) {
+        high = 0x8f;         // beyond U+10FFFF
+    }
+}
+
+void scanScalar(const unsigned char* blocks, size_t count, ContentProfile& profile,
+                unsigned char* tail) {
+    // Resume a sequence the previous block left open
+    int remaining = 0;
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    for (int back = 0; back < 3; back++) {
+        unsigned char c = tail[2 - back];
+        if (c < 0x80) {
+            break;
+        }
+        if (c >= 0xc0) {
+            int length = leadLength(c);
+            if (length > back + 1) {
+                remaining = length - back - 1;
+                if (back == 0) {
+                    secondByteRange(c, low, high);
+                }
+            }
+            break;
+        }
+    }
+
+    bool valid = profile.validUtf8;
+    bool nul = false;
+    bool previousCR = tail[2] == '\r';
+    const unsigned char* end = blocks + count * kBlock;
+    for (const unsigned char* p = blocks; p < end; p++) {
+        unsigned char c = *p;
+        if (remaining > 0) {
+            if (c < low || c > high) {
+                valid = false;
+            }
+            remaining--;
+            low = 0x80;
+            high = 0xbf;
+        } else if (c >= 0x80) {
+            int length = leadLength(c);
+            if (length == 0) {
+                valid = false;
+            } else {
+                remaining = length - 1;
+                secondByteRange(c, low, high);
+            }
+        }
+        if (c == '\n') {
+            if (previousCR) {
+                profile.crlfLines++;
+            } else {
+                profile.lfLines++;
+            }
+        } else if (c == 0) {
+            nul = true;
+        }
+        previousCR = c == '\r';
+    }
+
+    profile.validUtf8 = valid;
+    profile.hasNul = profile.hasNul || nul;
+    std::memcpy(tail, end - 3, 3);
+}
+
+#ifdef GITHUB_MANAGER_CONTENT_SCAN_X86
+
+// UTF-8 validation after Keiser and Lemire, "Validating UTF-8 In Less Than
+// One Instruction Per Byte" (2021). Three nibble lookups flag the errors a
+// pair of adjacent bytes can show; a separate check makes sure third and
+// fourth bytes of long sequences are continuations.
+const unsigned char kTooShort = 1 << 0;
+const unsigned char kTooLong = 1 << 1;
+const unsigned char kOverlong3 = 1 << 2;
+const unsigned char kTooLarge = 1 << 3;
+const unsigned char kSurrogate = 1 << 4;
+const unsigned char kOverlong2 = 1 << 5;
+const unsigned char kTooLarge1000 = 1 << 6;
+const unsigned char kOverlong4 = 1 << 6;
+const unsigned char kTwoConts = 1 << 7;
+const unsigned char kCarry = kTooShort | kTooLong | kTwoConts;
+
+__attribute__((target("avx2")))
+inline __m256i lookup(__m256i nibbles, const unsigned char* table) {
+    __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(half), nibbles);
+}
+
+// The 32 bytes ending n bytes before input's first byte
+template <int N>
+__attribute__((target("avx2")))
+inline __m256i previous(__m256i input, __m256i prior) {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prior, input, 0x21), 16 - N);
+}
+
+__attribute__((target("avx2")))
+inline __m256i checkUtf8(__m256i input, __m256i prior) {
+    static const unsigned char kByte1High[16] = {
+        kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+        kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+        kTooShort | kOverlong2,
+        kTooShort,
+        kTooShort | kOverlong3 | kSurrogate,
+        kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+    };
+    static const unsigned char kByte1Low[16] = {
+        kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+        kCarry | kOverlong2,
+        kCarry,
+        kCarry,
+        kCarry | kTooLarge,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+        kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000,
+    };
+    static const unsigned char kByte2High[16] = {
+        kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+        kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+        kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+        kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+        kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+        kTooShort, kTooShort, kTooShort, kTooShort,
+    };
+
+    const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+    __m256i prev1 = previous<1>(input, prior);
+    __m256i byte1High = lookup(_mm256_and_si256(_mm256_srli_epi16(prev1, 4), lowNibble), kByte1High);
+    __m256i byte1Low = lookup(_mm256_and_si256(prev1, lowNibble), kByte1Low);
+    __m256i byte2High = lookup(_mm256_and_si256(_mm256_srli_epi16(input, 4), lowNibble), kByte2High);
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+    // Bytes two and three after a 3- or 4-byte lead must be continuations,
+    // which the pair check flags as TWO_CONTS; the flag is expected there
+    __m256i third = _mm256_subs_epu8(previous<2>(input, prior), _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(previous<3>(input, prior), _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+    return _mm256_xor_si256(must23, special);
+}
+
+// Non-zero where the block ends inside a sequence
+__attribute__((target("avx2")))
+inline __m256i incomplete(__m256i input) {
+    const __m256i limits = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xf0 - 1), static_cast<char>(0xe0 - 1), static_cast<char>(0xc0 - 1));
+    return _mm256_subs_epu8(input, limits);
+}
+
+__attribute__((target("avx2,popcnt")))
+void scanAVX2(const unsigned char* blocks, size_t count, ContentProfile& profile,
+              unsigned char* tail) {
+    alignas(32) unsigned char context[32] = {0};
+    std::memcpy(context + 29, tail, 3);
+    __m256i prior = _mm256_load_si256(reinterpret_cast<const __m256i*>(context));
+    __m256i priorIncomplete = incomplete(prior);
+    __m256i error = _mm256_setzero_si256();
+    unsigned long long previousCR = tail[2] == '\r';
+    unsigned long long crlf = 0;
+    unsigned long long lf = 0;
+    unsigned nul = 0;
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriage = _mm256_set1_epi8('\r');
+
+    for (size_t i = 0; i < count; i++) {
+        const unsigned char* p = blocks + i * kBlock;
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+
+        nul |= static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, zero)) |
+                                     _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, zero)));
+
+        unsigned long long lfMask =
+            static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, newline))) |
+            static_cast<unsigned long long>(
+                static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, newline)))) << 32;
+        unsigned long long crMask =
+            static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, carriage))) |
+            static_cast<unsigned long long>(
+                static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, carriage)))) << 32;
+        unsigned long long afterCR = lfMask & ((crMask << 1) | previousCR);
+        crlf += _mm_popcnt_u64(afterCR);
+        lf += _mm_popcnt_u64(lfMask & ~afterCR);
+        previousCR = crMask >> 63;
+
+        // ASCII blocks, the common case, only need the carried check
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {
+            error = _mm256_or_si256(error, priorIncomplete);
+            priorIncomplete = zero;
+        } else {
+            error = _mm256_or_si256(error, checkUtf8(a, prior));
+            error = _mm256_or_si256(error, checkUtf8(b, a));
+            priorIncomplete = incomplete(b);
+        }
+        prior = b;
+    }
+
+    profile.crlfLines += crlf;
+    profile.lfLines += lf;
+    profile.hasNul = profile.hasNul || nul != 0;
+    if (!_mm256_testz_si256(error, error)) {
+        profile.validUtf8 = false;
+    }
+    std::memcpy(tail, blocks + count * kBlock - 3, 3);
+}
+
+bool hasAVX2() {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+}
+
+#endif
+
+const Kernel kKernels[] = {
+    {"scalar", scanScalar, always},
+#ifdef GITHUB_MANAGER_CONTENT_SCAN_X86
+    {"avx2", scanAVX2, hasAVX2},
+#endif
+};
+
+const Kernel* findKernel(const std::string& name) {
+    for (const Kernel& kernel : kKernels) {
+        if (name == kernel.name && kernel.supported()) {
+            return &kernel;
+        }
+    }
+    return nullptr;
+}
+
+const Kernel* bestKernel() {
+    const char* forced = std::getenv("GITHUB_MANAGER_CONTENT_SCAN");
+    if (forced) {
+        const Kernel* kernel = findKernel(forced);
+        if (kernel) {
+            return kernel;
+        }
+    }
+
+    const Kernel* best = &kKernels[0];
+    for (const Kernel& kernel : kKernels) {
+        if (kernel.supported()) {
+            best = &kernel;
+        }
+    }
+    return best;
+}
+
+std::atomic<const Kernel*> selected{nullptr};
+
+const Kernel* activeKernel() {
+    const Kernel* kernel = selected.load(std::memory_order_acquire);
+    if (!kernel) {
+        kernel = bestKernel();
+        selected.store(kernel, std::memory_order_release);
+    }
+    return kernel;
+}
+
+struct TypeByExtension {
+    const char* extension;
+    const char* type;
+};
+
+const TypeByExtension kTypes[] = {
+    {".c", "text/x-c"}, {".cc", "text/x-c++"}, {".cpp", "text/x-c++"},
+    {".css", "text/css"}, {".csv", "text/csv"}, {".gif", "image/gif"},
+    {".gz", "application/gzip"}, {".h", "text/x-c"}, {".hpp", "text/x-c++"},
+    {".htm", "text/html"}, {".html", "text/html"}, {".ico", "image/vnd.microsoft.icon"},
+    {".jpeg", "image/jpeg"}, {".jpg", "image/jpeg"}, {".js", "text/javascript"},
+    {".json", "application/json"}, {".md", "text/markdown"}, {".pdf", "application/pdf"},
+    {".png", "image/png"}, {".py", "text/x-python"}, {".sh", "application/x-sh"},
+    {".svg", "image/svg+xml"}, {".tar", "application/x-tar"}, {".txt", "text/plain"},
+    {".wasm", "application/wasm"}, {".webp", "image/webp"}, {".xml", "application/xml"},
+    {".yaml", "application/yaml"}, {".yml", "application/yaml"}, {".zip", "application/zip"},
+};
+
+}
+
+void ContentScanner::update(const void* data, size_t size) {
+    const unsigned char* in = static_cast<const unsigned char*>(data);
+    ScanKernel scan = activeKernel()->scan;
+    profile.size += size;
+
+    // Complete the block left over from the previous piece first
+    if (pendingSize > 0) {
+        size_t n = std::min(size, kBlock - pendingSize);
+        std::memcpy(pending + pendingSize, in, n);
+        pendingSize += n;
+        in += n;
+        size -= n;
+        if (pendingSize < kBlock) {
+            return;
+        }
+        scan(pending, 1, profile, tail);
+        pendingSize = 0;
+    }
+
+    size_t blocks = size / kBlock;
+    if (blocks > 0) {
+        scan(in, blocks, profile, tail);
+    }
+    pendingSize = size - blocks * kBlock;
+    std::memcpy(pending, in + blocks * kBlock, pendingSize);
+}
+
+ContentProfile ContentScanner::finish() {
+    // Spaces fill the last block: they are neither NULs nor line ends, and
+    // a sequence they cut off is reported as invalid
+    std::memset(pending + pendingSize, ' ', kBlock - pendingSize);
+    activeKernel()->scan(pending, 1, profile, tail);
+    pendingSize = 0;
+    return profile;
+}
+
+void ContentScanner::reset() {
+    profile = ContentProfile();
+    std::memset(tail, 0, sizeof(tail));
+    pendingSize = 0;
+}
+
+bool scanFile(const std::string& path, ContentProfile& profile) {
+    FileSource source(path);
+    if (!source.isOpen()) {
+        return false;
+    }
+
+    ContentScanner scanner;
+    const char* data;
+    size_t length;
+    while (source.next(data, length)) {
+        scanner.update(data, length);
+    }
+    profile = scanner.finish();
+    return !source.failed();
+}
+
+std::string contentType(const std::string& path, const ContentProfile& profile) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (const TypeByExtension& entry : kTypes) {
+        if (extension == entry.extension) {
+            return entry.type;
+        }
+    }
+    return profile.binary() ? "application/octet-stream" : "text/plain; charset=utf-8";
+}
+
+const char* contentScanKernelName() {
+    return activeKernel()->name;
+}
+
+std::vector<std::string> contentScanKernels() {
+    std::vector<std::string> names;
+    for (const Kernel& kernel : kKernels) {
+        if (kernel.supported()) {
+            names.push_back(kernel.name);
+        }
+    }
+    return names;
+}
+
+bool selectContentScanKernel(const std::string& name) {
+    const Kernel* kernel = findKernel(name);
+    if (!kernel) {
+        return false;
+    }
+    selected.store(kernel, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef GITHUB_MANAGER_CONTENT_SCAN_H
+#define GITHUB_MANAGER_CONTENT_SCAN_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// What a file holds, as far as the upload policy cares.
+struct ContentProfile {
+    unsigned long long size = 0;
+    bool hasNul = false;
+    bool validUtf8 = true;
+    unsigned long long crlfLines = 0;   // lines ending in "\r\n"
+    unsigned long long lfLines = 0;     // lines ending in a bare "\n"
+
+    // Same rule as the web app's File.is_binary: NUL bytes or text that is
+    // not UTF-8
+    bool binary() const { return hasNul || !validUtf8; }
+    bool mixedLineEndings() const { return crlfLines > 0 && lfLines > 0; }
+};
+
+// Classifies content in one pass: NUL bytes, UTF-8 validity (overlongs,
+// surrogates and truncated sequences included) and line endings. Data may
+// arrive in pieces of any size.
+//
+// Whole 64-byte blocks go through a scalar or AVX2 kernel; the AVX2 one
+// validates UTF-8 with nibble lookups (Keiser and Lemire) and counts line
+// endings on bit masks, fast enough to keep up with memory bandwidth.
+// GITHUB_MANAGER_CONTENT_SCAN=<name> in the environment overrides the
+// choice of kernel.
+class ContentScanner {
+public:
+    static const size_t kBlockSize = 64;
+
+    void update(const void* data, size_t size);
+
+    // Ends the input and returns the result. A sequence cut off by the end
+    // of the input makes it invalid UTF-8.
+    ContentProfile finish();
+
+    void reset();
+
+private:
+    ContentProfile profile;
+    unsigned char tail[3] = {0, 0, 0};   // last bytes of the previous block
+    unsigned char pending[kBlockSize];
+    size_t pendingSize = 0;
+};
+
+// Scans the whole file; false if it cannot be read.
+bool scanFile(const std::string& path, ContentProfile& profile);
+
+// MIME type for the file, from its extension and, failing that, whether it
+// is text ("text/plain; charset=utf-8") or not ("application/octet-stream").
+std::string contentType(const std::string& path, const ContentProfile& profile);
+
+// Name of the kernel in use ("scalar", "avx2").
+const char* contentScanKernelName();
+
+// Kernels usable on this CPU.
+std::vector<std::string> contentScanKernels();
+
+// Switches to the named kernel; false if it is unknown or unsupported.
+bool selectContentScanKernel(const std::string& name);
+
+#endif
@@ -0,0 +1,56 @@
+#include "contents_payload.h"
+
+void appendJsonString(std::string& out, const std::string& value) {
+    static const char kHex[] = "0123456789abcdef";
+
+    out += '"';
+    for (char c : value) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (byte < 0x20) {
+                    out += "\\u00";
+                    out += kHex[byte >> 4];
+                    out += kHex[byte & 0x0f];
+                } else {
+                    // UTF-8 passes through unchanged; JSON allows it
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+std::string ContentsPayload::head() const {
+    if (gitBlob) {
+        return "{\"encoding\":\"base64\",\"content\":\"";
+    }
+    std::string out = "{\"message\":";
+    appendJsonString(out, message);
+    out += ",\"content\":\"";
+    return out;
+}
+
+std::string ContentsPayload::tail() const {
+    if (gitBlob) {
+        return "\"}";
+    }
+    std::string out = "\"";
+    if (!sha.empty()) {
+        out += ",\"sha\":";
+        appendJsonString(out, sha);
+    }
+    if (!branch.empty()) {
+        out += ",\"branch\":";
+        appendJsonString(out, branch);
+    }
+    out += "}";
+    return out;
+}
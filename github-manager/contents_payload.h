@@ -0,0 +1,39 @@
+#ifndef GITHUB_MANAGER_CONTENTS_PAYLOAD_H
+#define GITHUB_MANAGER_CONTENTS_PAYLOAD_H
+
+#include <string>
+
+// Appends value to out as a quoted, escaped JSON string.
+void appendJsonString(std::string& out, const std::string& value);
+
+// Body of a contents API PUT:
+//   {"message":...,"content":"<base64>","sha":...,"branch":...}
+// The document is written as a head and a tail around the content, so the
+// base64 text can be placed in the final buffer (or streamed) directly
+// instead of going through a JSON DOM and writer. Only the small fields
+// are escaped; base64 never needs escaping.
+//
+// blob() gives the body of a Git Data API blob POST instead,
+//   {"encoding":"base64","content":"<base64>"}
+// which has the same shape and so goes through the same encoders.
+struct ContentsPayload {
+    std::string message;
+    std::string sha;      // blob being replaced; empty for a new file
+    std::string branch;   // empty for the default branch
+    bool gitBlob = false;
+
+    explicit ContentsPayload(const std::string& _message) : message(_message) {}
+
+    static ContentsPayload blob() {
+        ContentsPayload payload("");
+        payload.gitBlob = true;
+        return payload;
+    }
+
+    // Everything up to the opening quote of the content value
+    std::string head() const;
+    // Everything after the content value
+    std::string tail() const;
+};
+
+#endif
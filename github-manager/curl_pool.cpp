@@ -0,0 +1,68 @@
+#include "curl_pool.h"
+
+CurlHandlePool::~CurlHandlePool() {
+    clear();
+}
+
+CurlHandlePool::Lease CurlHandlePool::acquire() {
+    CURL* handle = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<CURL*>& handles = idle[std::this_thread::get_id()];
+        if (!handles.empty()) {
+            handle = handles.back();
+            handles.pop_back();
+        }
+    }
+
+    if (handle) {
+        reset(handle);
+    } else if ((handle = curl_easy_init()) && share) {
+        share->attach(handle);
+    }
+    return Lease(this, handle);
+}
+
+void CurlHandlePool::reset(CURL* handle) {
+    curl_easy_reset(handle);
+    if (share) {
+        share->attach(handle);
+    }
+}
+
+void CurlHandlePool::release(CURL* handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle[std::this_thread::get_id()].push_back(handle);
+}
+
+void CurlHandlePool::recordTransfer(CURL* handle, const HttpResponse& response) {
+    wireBytes += response.wireBytes;
+    decodedBytes += response.decodedBytes;
+
+    long connects = 0;
+    if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects) != CURLE_OK) {
+        return;
+    }
+    requests++;
+    if (connects > 0) {
+        newConnections++;
+    }
+}
+
+void CurlHandlePool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : idle) {
+        for (CURL* handle : entry.second) {
+            curl_easy_cleanup(handle);
+        }
+    }
+    idle.clear();
+}
+
+double CurlHandlePool::reuseRatio() const {
+    long total = requests.load();
+    if (total == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(total - newConnections.load()) / total;
+}
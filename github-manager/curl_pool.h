@@ -0,0 +1,90 @@
+#ifndef GITHUB_MANAGER_CURL_POOL_H
+#define GITHUB_MANAGER_CURL_POOL_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <curl/curl.h>
+#include "curl_share.h"
+#include "http_transport.h"
+
+// Pool of reusable cURL easy handles, kept per calling thread.
+//
+// A handle is reset with curl_easy_reset() when it is handed out again,
+// which clears its options but keeps its connection cache, DNS cache and
+// TLS session cache. Consecutive requests to api.github.com from the same
+// thread therefore ride on one warm keep-alive connection instead of paying
+// a fresh TCP + TLS handshake each time.
+class CurlHandlePool {
+public:
+    // RAII lease; the handle goes back to the owning thread's free list
+    // when the lease is destroyed.
+    class Lease {
+    public:
+        Lease(CurlHandlePool* _pool, CURL* _handle) : pool(_pool), handle(_handle) {}
+        Lease(Lease&& other) noexcept : pool(other.pool), handle(other.handle) {
+            other.handle = nullptr;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() {
+            if (handle) {
+                pool->release(handle);
+            }
+        }
+
+        CURL* get() const { return handle; }
+        explicit operator bool() const { return handle != nullptr; }
+
+    private:
+        CurlHandlePool* pool;
+        CURL* handle;
+    };
+
+    CurlHandlePool() = default;
+    CurlHandlePool(const CurlHandlePool&) = delete;
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+    ~CurlHandlePool();
+
+    // Attaches every handle handed out from now on to a shared cache.
+    void setShare(CurlShare* _share) { share = _share; }
+
+    // Hands out an idle handle of the calling thread (reset to defaults),
+    // or a fresh one if the thread has none left.
+    Lease acquire();
+
+    // Resets a leased handle for its next request, keeping it attached to
+    // the shared cache.
+    void reset(CURL* handle);
+
+    // Records whether the finished transfer had to open a new connection,
+    // and how many body bytes it moved before and after decoding.
+    void recordTransfer(CURL* handle, const HttpResponse& response);
+
+    // Closes every idle handle. Must run before curl_global_cleanup().
+    void clear();
+
+    long requestCount() const { return requests.load(); }
+    long newConnectionCount() const { return newConnections.load(); }
+    long long wireByteCount() const { return wireBytes.load(); }
+    long long decodedByteCount() const { return decodedBytes.load(); }
+
+    // Fraction of requests that reused an already established connection.
+    double reuseRatio() const;
+
+private:
+    void release(CURL* handle);
+
+    CurlShare* share = nullptr;
+    std::mutex mutex;
+    std::unordered_map<std::thread::id, std::vector<CURL*>> idle;
+    std::atomic<long> requests{0};
+    std::atomic<long> newConnections{0};
+    std::atomic<long long> wireBytes{0};
+    std::atomic<long long> decodedBytes{0};
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "curl_share.h"
+
+#include <openssl/ssl.h>
+
+CurlShare::CurlShare(long _maxConnections)
+    : share(curl_share_init()), maxConnections(_maxConnections) {
+    if (!share) {
+        return;
+    }
+
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, &CurlShare::lock);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, &CurlShare::unlock);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+}
+
+CurlShare::~CurlShare() {
+    if (share) {
+        curl_share_cleanup(share);
+    }
+}
+
+void CurlShare::attach(CURL* curl) {
+    if (share) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        curl_easy_setopt(curl, CURLOPT_MAXCONNECTS, maxConnections);
+    }
+    curl_easy_setopt(curl, CURLOPT_RESOLVER_START_FUNCTION, &CurlShare::onResolverStart);
+    curl_easy_setopt(curl, CURLOPT_RESOLVER_START_DATA, this);
+#if LIBCURL_VERSION_NUM >= 0x075000
+    Probe* probe;
+    {
+        std::lock_guard<std::mutex> guard(probesLock);
+        std::unique_ptr<Probe>& slot = probes[curl];
+        if (!slot) {
+            slot = std::make_unique<Probe>(Probe{this, curl});
+        }
+        probe = slot.get();
+    }
+    curl_easy_setopt(curl, CURLOPT_PREREQFUNCTION, &CurlShare::onConnected);
+    curl_easy_setopt(curl, CURLOPT_PREREQDATA, probe);
+#endif
+}
+
+long CurlShare::dnsHits() const {
+    // Every new connection needs a name; those that did not start a
+    // resolve were served from the shared DNS cache
+    long hits = connects.load() - resolves.load();
+    return hits > 0 ? hits : 0;
+}
+
+void CurlShare::lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    static_cast<CurlShare*>(userptr)->locks[data].lock();
+}
+
+void CurlShare::unlock(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<CurlShare*>(userptr)->locks[data].unlock();
+}
+
+int CurlShare::onResolverStart(void*, void*, void* userdata) {
+    static_cast<CurlShare*>(userdata)->resolves++;
+    return 0;
+}
+
+#if LIBCURL_VERSION_NUM >= 0x075000
+int CurlShare::onConnected(void* data, char*, char*, int, int) {
+    Probe* probe = static_cast<Probe*>(data);
+    CurlShare* self = probe->owner;
+    CURL* curl = probe->handle;
+    long newConnections = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &newConnections);
+    if (newConnections == 0) {
+        return CURL_PREREQFUNC_OK;
+    }
+    self->connects++;
+
+    // The SSL object is only reachable while the connection is live
+    struct curl_tlssessioninfo* tls = nullptr;
+    if (curl_easy_getinfo(curl, CURLINFO_TLS_SSL_PTR, &tls) == CURLE_OK && tls &&
+        tls->backend == CURLSSLBACKEND_OPENSSL && tls->internals) {
+        if (SSL_session_reused(static_cast<SSL*>(tls->internals))) {
+            self->tlsResumptions++;
+        } else {
+            self->tlsHandshakes++;
+        }
+    }
+    return CURL_PREREQFUNC_OK;
+}
+#endif
@@ -0,0 +1,61 @@
+#ifndef GITHUB_MANAGER_CURL_SHARE_H
+#define GITHUB_MANAGER_CURL_SHARE_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <curl/curl.h>
+
+// Process-wide cURL share object.
+//
+// Every easy handle attached to it uses one DNS cache, one TLS session
+// cache and one connection cache, so N parallel workers resolve
+// api.github.com once and resume TLS sessions instead of each running a
+// full handshake. Access is serialized by one mutex per shared data type.
+// The cache-hit probes attached to each handle report to the share the
+// handle was attached to.
+class CurlShare {
+public:
+    // maxConnections bounds the shared connection cache; it must cover all
+    // concurrent transfers or live connections get evicted between requests.
+    explicit CurlShare(long maxConnections);
+    CurlShare(const CurlShare&) = delete;
+    CurlShare& operator=(const CurlShare&) = delete;
+    ~CurlShare();
+
+    // Attaches the share and the cache-hit probes to an easy handle. Needs
+    // to be repeated after curl_easy_reset().
+    void attach(CURL* curl);
+
+    long dnsLookups() const { return resolves.load(); }
+    long dnsHits() const;
+    long tlsResumed() const { return tlsResumptions.load(); }
+    long tlsFullHandshakes() const { return tlsHandshakes.load(); }
+
+private:
+    static void lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlock(CURL* handle, curl_lock_data data, void* userptr);
+    static int onResolverStart(void* resolverState, void* reserved, void* userdata);
+    static int onConnected(void* data, char* primaryIP, char* localIP,
+                           int primaryPort, int localPort);
+
+    // What the connect probe of one handle needs: curl hands the callback
+    // only its data pointer, not the handle
+    struct Probe {
+        CurlShare* owner;
+        CURL* handle;
+    };
+
+    CURLSH* share;
+    long maxConnections;
+    std::mutex locks[CURL_LOCK_DATA_LAST];
+    std::mutex probesLock;
+    std::map<CURL*, std::unique_ptr<Probe>> probes;
+    std::atomic<long> connects{0};
+    std::atomic<long> resolves{0};
+    std::atomic<long> tlsResumptions{0};
+    std::atomic<long> tlsHandshakes{0};
+};
+
+#endif
@@ -0,0 +1,425 @@
+#include "dir_walker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+void FileList::add(std::string_view directory, std::string_view name, uint64_t size) {
+    Entry entry;
+    entry.offset = names.size();
+    if (!directory.empty()) {
+        names.append(directory);
+        names.push_back('/');
+    }
+    names.append(name);
+    entry.length = static_cast<uint32_t>(names.size() - entry.offset);
+    entry.size = size;
+    entries.push_back(entry);
+}
+
+void FileList::append(FileList&& other) {
+    if (entries.empty()) {
+        *this = std::move(other);
+        return;
+    }
+    size_t base = names.size();
+    names.append(other.names);
+    entries.reserve(entries.size() + other.entries.size());
+    for (Entry entry : other.entries) {
+        entry.offset += base;
+        entries.push_back(entry);
+    }
+    other = FileList();
+}
+
+void FileList::sort() {
+    const char* text = names.data();
+    std::sort(entries.begin(), entries.end(), [text](const Entry& a, const Entry& b) {
+        return std::string_view(text + a.offset, a.length) <
+               std::string_view(text + b.offset, b.length);
+    });
+}
+
+namespace {
+
+const size_t kDirentBuffer = 64 * 1024;
+
+// Calls visit(name, d_type) for every entry of the open directory fd
+// except . and ..; false on a read error.
+template <typename Visit>
+bool readEntries(int fd, std::vector<char>& buffer, Visit visit) {
+#ifdef __linux__
+    // The kernel's layout; glibc only declares it from 2.30 on
+    struct LinuxDirent64 {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+    for (;;) {
+        long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (n < 0) {
+            return false;
+        }
+        if (n == 0) {
+            return true;
+        }
+        for (long at = 0; at < n;) {
+            const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(buffer.data() + at);
+            at += entry->d_reclen;
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            visit(name, entry->d_type);
+        }
+    }
+#else
+    (void)buffer;
+    int copy = ::dup(fd);
+    DIR* dir = copy >= 0 ? ::fdopendir(copy) : nullptr;
+    if (!dir) {
+        if (copy >= 0) {
+            ::close(copy);
+        }
+        return false;
+    }
+    while (dirent* entry = ::readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+        visit(name, entry->d_type);
+    }
+    ::closedir(dir);
+    return true;
+#endif
+}
+
+unsigned char typeFromMode(mode_t mode) {
+    if (S_ISDIR(mode)) {
+        return DT_DIR;
+    }
+    if (S_ISREG(mode)) {
+        return DT_REG;
+    }
+    if (S_ISLNK(mode)) {
+        return DT_LNK;
+    }
+    return DT_UNKNOWN;
+}
+
+// Reads a small file relative to an open directory
+bool readRelative(int directoryFd, const char* name, std::string& content) {
+    int fd = ::openat(directoryFd, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char chunk[4096];
+    ssize_t n;
+    content.clear();
+    while ((n = ::read(fd, chunk, sizeof(chunk))) != 0) {
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            break;
+        }
+        content.append(chunk, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return n == 0;
+}
+
+// The .gitignore patterns in effect in a directory: those of its own
+// file, then its parents'. Shared by all the directories below it.
+struct IgnoreFrame {
+    std::shared_ptr<const IgnoreFrame> parent;
+    std::string base;   // directory of the .gitignore, relative to the root
+    IgnoreRules rules;
+};
+
+class Walk {
+public:
+    Walk(int _rootFd, unsigned threads, const IgnoreRules& _commandLine,
+         const IgnoreRules& _infoExclude, bool _useGitignore)
+        : rootFd(_rootFd), commandLine(_commandLine), infoExclude(_infoExclude),
+          useGitignore(_useGitignore) {
+        for (unsigned i = 0; i < threads; i++) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    void run(FileList& files, size_t& directories, size_t& excluded) {
+        push(*workers[0], Pending{std::string(), nullptr});
+
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < workers.size(); i++) {
+            pool.emplace_back([this, i]() { work(*workers[i]); });
+        }
+        work(*workers[0]);
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+
+        directories = 0;
+        excluded = 0;
+        for (std::unique_ptr<Worker>& worker : workers) {
+            files.append(std::move(worker->files));
+            directories += worker->directories;
+            excluded += worker->excluded;
+            for (const std::string& error : worker->errors) {
+                std::cerr << error << std::endl;
+            }
+        }
+        files.sort();
+    }
+
+private:
+    struct Pending {
+        std::string path;   // relative to the root
+        std::shared_ptr<const IgnoreFrame> ignores;
+    };
+
+    struct Worker {
+        std::mutex lock;
+        std::deque<Pending> pending;
+        FileList files;
+        size_t directories = 0;
+        size_t excluded = 0;
+        std::vector<std::string> errors;
+        std::vector<char> buffer;
+        // Entries of the directory being read, NUL separated, with types
+        std::string names;
+        std::vector<std::pair<size_t, unsigned char>> entries;
+        std::string path;
+        std::string gitignore;
+    };
+
+    void push(Worker& worker, Pending directory) {
+        outstanding++;
+        {
+            std::lock_guard<std::mutex> guard(worker.lock);
+            worker.pending.push_back(std::move(directory));
+            queued++;
+        }
+        wake(false);
+    }
+
+    // Own work newest first (depth first, warm caches); stolen work oldest
+    // first, which is nearest the root and so usually the biggest subtree
+    bool take(Worker& self, Pending& directory) {
+        {
+            std::lock_guard<std::mutex> guard(self.lock);
+            if (!self.pending.empty()) {
+                directory = std::move(self.pending.back());
+                self.pending.pop_back();
+                queued--;
+                return true;
+            }
+        }
+        for (std::unique_ptr<Worker>& other : workers) {
+            if (other.get() == &self) {
+                continue;
+            }
+            std::lock_guard<std::mutex> guard(other->lock);
+            if (!other->pending.empty()) {
+                directory = std::move(other->pending.front());
+                other->pending.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(Worker& self) {
+        self.buffer.resize(kDirentBuffer);
+        Pending directory;
+        for (;;) {
+            if (take(self, directory)) {
+                read(self, directory);
+                if (--outstanding == 0) {
+                    wake(true);
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> guard(idleLock);
+            sleepers++;
+            idle.wait(guard, [this]() { return queued > 0 || outstanding == 0; });
+            sleepers--;
+            if (outstanding == 0) {
+                return;
+            }
+        }
+    }
+
+    // Sleepers register under idleLock before checking for work, so taking
+    // the lock here orders this wake-up after their check
+    void wake(bool everyone) {
+        if (sleepers == 0) {
+            return;
+        }
+        { std::lock_guard<std::mutex> guard(idleLock); }
+        if (everyone) {
+            idle.notify_all();
+        } else {
+            idle.notify_one();
+        }
+    }
+
+    // Command line patterns outrank every .gitignore, the deepest of
+    // which outranks its parents; .git/info/exclude comes last
+    bool excluded(const IgnoreFrame* frame, std::string_view path, std::string_view name,
+                  bool directory) const {
+        IgnoreRules::Match match = commandLine.match(path, name, directory);
+        for (; match == IgnoreRules::kNone && frame; frame = frame->parent.get()) {
+            std::string_view relative =
+                frame->base.empty() ? path : path.substr(frame->base.size() + 1);
+            match = frame->rules.match(relative, name, directory);
+        }
+        if (match == IgnoreRules::kNone) {
+            match = infoExclude.match(path, name, directory);
+        }
+        return match == IgnoreRules::kIgnored;
+    }
+
+    void read(Worker& self, const Pending& pending) {
+        const std::string& directory = pending.path;
+        int fd = ::openat(rootFd, directory.empty() ? "." : directory.c_str(),
+                          O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0) {
+            self.errors.push_back("Cannot read directory " + directory + ": " + std::strerror(errno));
+            return;
+        }
+        self.directories++;
+
+        // The whole listing first: a .gitignore applies to its siblings
+        self.names.clear();
+        self.entries.clear();
+        bool hasGitignore = false;
+        bool ok = readEntries(fd, self.buffer, [&](const char* name, unsigned char type) {
+            hasGitignore = hasGitignore || std::strcmp(name, ".gitignore") == 0;
+            self.entries.emplace_back(self.names.size(), type);
+            self.names.append(name);
+            self.names.push_back('\0');
+        });
+        if (!ok) {
+            self.errors.push_back("Cannot read directory " + directory + ": " + std::strerror(errno));
+        }
+
+        std::shared_ptr<const IgnoreFrame> ignores = pending.ignores;
+        if (useGitignore && hasGitignore && readRelative(fd, ".gitignore", self.gitignore)) {
+            auto frame = std::make_shared<IgnoreFrame>();
+            frame->rules.parse(self.gitignore);
+            if (!frame->rules.empty()) {
+                frame->parent = std::move(ignores);
+                frame->base = directory;
+                ignores = std::move(frame);
+            }
+        }
+        bool filtering = ignores || !commandLine.empty() || !infoExclude.empty();
+
+        for (const auto& entry : self.entries) {
+            const char* name = self.names.data() + entry.first;
+            unsigned char type = entry.second;
+            // Whatever it is: a directory in a repository, a file pointing
+            // at the real one in worktrees and submodules
+            if (std::strcmp(name, ".git") == 0) {
+                continue;
+            }
+            struct stat info;
+            if (type == DT_UNKNOWN) {
+                // Some filesystems do not fill in d_type
+                if (::fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW) != 0) {
+                    continue;
+                }
+                type = typeFromMode(info.st_mode);
+            }
+            if (type != DT_DIR && type != DT_REG && type != DT_LNK) {
+                continue;
+            }
+
+            self.path.assign(directory);
+            if (!directory.empty()) {
+                self.path.push_back('/');
+            }
+            self.path.append(name);
+            if (filtering && excluded(ignores.get(), self.path, name, type == DT_DIR)) {
+                // An excluded directory is never opened
+                self.excluded++;
+                continue;
+            }
+
+            if (type == DT_DIR) {
+                push(self, Pending{self.path, ignores});
+            } else {
+                // The size is needed anyway; stat'ing relative to the open
+                // directory skips resolving the path again
+                int flags = type == DT_REG ? AT_SYMLINK_NOFOLLOW : 0;
+                if (::fstatat(fd, name, &info, flags) == 0 && S_ISREG(info.st_mode)) {
+                    self.files.add(directory, name, static_cast<uint64_t>(info.st_size));
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    int rootFd;
+    const IgnoreRules& commandLine;
+    const IgnoreRules& infoExclude;
+    bool useGitignore;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> outstanding{0};   // directories queued or being read
+    std::atomic<size_t> queued{0};        // directories waiting in a deque
+    std::atomic<unsigned> sleepers{0};
+    std::mutex idleLock;
+    std::condition_variable idle;
+};
+
+}
+
+DirectoryWalker::DirectoryWalker(unsigned _threads) : threads(_threads) {
+    if (threads == 0) {
+        threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), 16u);
+    }
+}
+
+void DirectoryWalker::setExcludes(IgnoreRules _commandLine, IgnoreRules _infoExclude,
+                                  bool _useGitignore) {
+    commandLine = std::move(_commandLine);
+    infoExclude = std::move(_infoExclude);
+    useGitignore = _useGitignore;
+}
+
+bool DirectoryWalker::walk(const std::string& root, FileList& files) {
+    files = FileList();
+    directoryCount = 0;
+    excludedCount = 0;
+    int rootFd = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd < 0) {
+        std::cerr << "Cannot open directory " << root << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    Walk walk(rootFd, threads, commandLine, infoExclude, useGitignore);
+    walk.run(files, directoryCount, excludedCount);
+    ::close(rootFd);
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef GITHUB_MANAGER_DIR_WALKER_H
+#define GITHUB_MANAGER_DIR_WALKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ignore_rules.h"
+
+// The regular files found by a walk, as '/' separated paths relative to
+// the root. Paths live back to back in one string; each entry is an offset,
+// a length and the file size, so a 500k-file tree costs a few tens of
+// megabytes rather than a std::string (and a heap block) per path.
+class FileList {
+public:
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    std::string_view path(size_t index) const {
+        const Entry& entry = entries[index];
+        return std::string_view(names.data() + entry.offset, entry.length);
+    }
+    uint64_t fileSize(size_t index) const { return entries[index].size; }
+
+    void add(std::string_view directory, std::string_view name, uint64_t size);
+    void append(FileList&& other);
+
+    // Orders by path, so walks are reproducible whatever the thread timing.
+    void sort();
+
+private:
+    struct Entry {
+        size_t offset;
+        uint32_t length;
+        uint64_t size;
+    };
+    std::string names;
+    std::vector<Entry> entries;
+};
+
+// Lists the regular files under a directory with a pool of threads.
+//
+// Each directory is read with getdents64 through a descriptor opened
+// relative to the root, and entry types come from d_type, so only regular
+// files are stat'ed (with fstatat on the open directory, for their size).
+// Subdirectories go onto the deque of the thread that found them; idle
+// threads steal the oldest (usually largest) pending directory from the
+// others, which keeps wide and deep trees equally busy.
+//
+// Like the iterator it replaces, symlinks to files are listed and symlinks
+// to directories are not followed. .git entries are skipped, whether the
+// directory of a repository or the file of a worktree or submodule.
+//
+// Entries are checked against the exclude patterns as they are read, so an
+// excluded directory is never opened. Each directory's .gitignore is
+// pushed onto the stack of its parents' and shared by the subtree.
+class DirectoryWalker {
+public:
+    // threads == 0 picks one per core, up to 16
+    explicit DirectoryWalker(unsigned _threads = 0);
+
+    // commandLine patterns outrank everything, infoExclude (the
+    // repository's .git/info/exclude) yields to any .gitignore; both are
+    // relative to the root. .gitignore files in the root and below are read
+    // unless useGitignore is false; those in directories above the root
+    // are not, as if the root were the top of a repository.
+    void setExcludes(IgnoreRules _commandLine, IgnoreRules _infoExclude, bool _useGitignore);
+
+    // False if root cannot be opened. Unreadable subdirectories are
+    // reported on std::cerr and skipped.
+    bool walk(const std::string& root, FileList& files);
+
+    size_t directoriesRead() const { return directoryCount; }
+    size_t entriesExcluded() const { return excludedCount; }
+
+private:
+    unsigned threads;
+    IgnoreRules commandLine;
+    IgnoreRules infoExclude;
+    bool useGitignore = true;
+    size_t directoryCount = 0;
+    size_t excludedCount = 0;
+};
+
+#endif
@@ -0,0 +1,359 @@
+#include "file_batch.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#define GITHUB_MANAGER_IO_URING 1
+#include <linux/io_uring.h>
+#endif
+
+namespace {
+
+// Tags completions of closes apart from those of reads
+const uint64_t kCloseTag = 1ull << 32;
+
+// Reads one byte more than expected, so a file that grew is noticed
+size_t readLength(size_t expected) {
+    return std::min(expected + 1, FileBatchReader::kSlotSize);
+}
+
+}
+
+FileBatchReader::FileBatchReader(bool useIoUring) : slots(kMaxFiles * kSlotSize) {
+    if (useIoUring && !setupRing()) {
+        closeRing();
+    }
+}
+
+FileBatchReader::~FileBatchReader() {
+    closeRing();
+}
+
+void FileBatchReader::load(const std::vector<std::string>& paths, const std::vector<size_t>& sizes,
+                           std::vector<LoadedFile>& files) {
+    files.assign(paths.size(), LoadedFile());
+    if (paths.size() > kMaxFiles) {
+        return;
+    }
+    if (ring >= 0 && loadWithRing(paths, sizes, files)) {
+        return;
+    }
+    loadWithPread(paths, sizes, files);
+}
+
+void FileBatchReader::loadWithPread(const std::vector<std::string>& paths,
+                                    const std::vector<size_t>& sizes,
+                                    std::vector<LoadedFile>& files) {
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (sizes[i] >= kSlotSize) {
+            continue;
+        }
+        int fd = ::open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        char* slot = slots.data() + i * kSlotSize;
+        size_t wanted = readLength(sizes[i]);
+        size_t got = 0;
+        while (got < wanted) {
+            ssize_t n = ::pread(fd, slot + got, wanted - got, static_cast<off_t>(got));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            got += static_cast<size_t>(n);
+        }
+        ::close(fd);
+
+        files[i].data = slot;
+        files[i].size = got;
+        files[i].loaded = got == sizes[i];
+    }
+}
+
+#ifdef GITHUB_MANAGER_IO_URING
+
+namespace {
+
+const unsigned kRingEntries = 2 * FileBatchReader::kMaxFiles;
+
+int enterRing(int ring, unsigned submit, unsigned wait) {
+    int result;
+    do {
+        result = static_cast<int>(::syscall(__NR_io_uring_enter, ring, submit, wait,
+                                            IORING_ENTER_GETEVENTS, nullptr, 0));
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+bool supports(const io_uring_probe* probe, unsigned op) {
+    return op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+}
+
+}
+
+bool FileBatchReader::setupRing() {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring = static_cast<int>(::syscall(__NR_io_uring_setup, kRingEntries, &params));
+    if (ring < 0) {
+        // ENOSYS, or EPERM where io_uring is disabled
+        return false;
+    }
+
+    sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap) {
+        sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+    }
+    sqMap = ::mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring,
+                   IORING_OFF_SQ_RING);
+    if (sqMap == MAP_FAILED) {
+        sqMap = nullptr;
+        return false;
+    }
+    if (singleMap) {
+        cqMap = sqMap;
+    } else {
+        cqMap = ::mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring, IORING_OFF_CQ_RING);
+        if (cqMap == MAP_FAILED) {
+            cqMap = nullptr;
+            return false;
+        }
+    }
+    sqeMapSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqeMap = ::mmap(nullptr, sqeMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring, IORING_OFF_SQES);
+    if (sqeMap == MAP_FAILED) {
+        sqeMap = nullptr;
+        return false;
+    }
+
+    char* sq = static_cast<char*>(sqMap);
+    char* cq = static_cast<char*>(cqMap);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = cq + params.cq_off.cqes;
+
+    // Opening and closing through the ring needs 5.6 or later
+    const unsigned probeOps = 256;
+    std::vector<char> probeBuffer(sizeof(io_uring_probe) + probeOps * sizeof(io_uring_probe_op));
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+    if (::syscall(__NR_io_uring_register, ring, IORING_REGISTER_PROBE, probe, probeOps) < 0 ||
+        !supports(probe, IORING_OP_OPENAT) || !supports(probe, IORING_OP_READ) ||
+        !supports(probe, IORING_OP_CLOSE)) {
+        return false;
+    }
+
+    // Registered buffers save pinning the pages on every read. They count
+    // against RLIMIT_MEMLOCK, so plain reads into the same slots are the
+    // fallback.
+    iovec buffer{slots.data(), slots.size()};
+    buffersRegistered =
+        supports(probe, IORING_OP_READ_FIXED) &&
+        ::syscall(__NR_io_uring_register, ring, IORING_REGISTER_BUFFERS, &buffer, 1) == 0;
+    return true;
+}
+
+void FileBatchReader::closeRing() {
+    if (sqeMap) {
+        ::munmap(sqeMap, sqeMapSize);
+        sqeMap = nullptr;
+    }
+    if (cqMap && cqMap != sqMap) {
+        ::munmap(cqMap, cqMapSize);
+    }
+    cqMap = nullptr;
+    if (sqMap) {
+        ::munmap(sqMap, sqMapSize);
+        sqMap = nullptr;
+    }
+    if (ring >= 0) {
+        ::close(ring);
+        ring = -1;
+    }
+    buffersRegistered = false;
+}
+
+bool FileBatchReader::loadWithRing(const std::vector<std::string>& paths,
+                                   const std::vector<size_t>& sizes,
+                                   std::vector<LoadedFile>& files) {
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(sqeMap);
+    io_uring_cqe* completions = static_cast<io_uring_cqe*>(cqes);
+
+    auto nextSqe = [&](unsigned& tail) {
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        tail++;
+        return sqe;
+    };
+
+    // Submits the count requests queued up to tail and hands each
+    // completion to done. Even when submitting fails part way, it returns
+    // only once every request the kernel accepted has completed, so none
+    // is left reading into a slot or opening a file behind our back. False
+    // if not all of them could be submitted.
+    bool abandoned = false;
+    auto run = [&](unsigned tail, unsigned count, auto done) {
+        __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+        unsigned submitted = 0;
+        unsigned seen = 0;
+        bool ok = true;
+        while (true) {
+            unsigned head = *cqHead;
+            unsigned ready = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != ready; head++, seen++) {
+                const io_uring_cqe& cqe = completions[head & *cqMask];
+                done(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+            bool moreToSubmit = ok && submitted < count;
+            if (!moreToSubmit && seen == submitted) {
+                return ok;
+            }
+            if (moreToSubmit) {
+                int result = enterRing(ring, count - submitted, 0);
+                if (result > 0) {
+                    submitted += static_cast<unsigned>(result);
+                    continue;
+                }
+                // A shortage of resources (EAGAIN, EBUSY) clears as
+                // requests complete; anything else, or no progress with
+                // nothing in flight, ends the batch
+                bool transient = result == 0 || errno == EAGAIN || errno == EBUSY;
+                if (!transient || seen == submitted) {
+                    ok = false;
+                    continue;
+                }
+            }
+            if (enterRing(ring, 0, 1) < 0) {
+                // Nothing can be waited for any more. The kernel may still
+                // write into the slots, so they are given up (leaked) and
+                // the plain reads get fresh ones.
+                new std::vector<char>(std::move(slots));
+                slots.assign(kMaxFiles * kSlotSize, 0);
+                abandoned = true;
+                return false;
+            }
+        }
+    };
+
+    // All opens of the batch at once
+    std::vector<int> fds(paths.size(), -1);
+    unsigned tail = *sqTail;
+    unsigned queued = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (sizes[i] >= kSlotSize) {
+            continue;
+        }
+        io_uring_sqe* sqe = nextSqe(tail);
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(paths[i].c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = i;
+        queued++;
+    }
+    bool ok = run(tail, queued, [&](uint64_t tag, int result) {
+        fds[tag] = result;
+    });
+    if (!ok) {
+        // Close what did open, and stop using the ring
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        closeRing();
+        return false;
+    }
+
+    // Then every read, each chained to the close of its file. A hard link
+    // runs the close even if the read fails.
+    std::vector<bool> closed(paths.size(), false);
+    tail = *sqTail;
+    queued = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (fds[i] < 0) {
+            continue;
+        }
+        char* slot = slots.data() + i * kSlotSize;
+        io_uring_sqe* read = nextSqe(tail);
+        read->opcode = buffersRegistered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        read->fd = fds[i];
+        read->addr = reinterpret_cast<uint64_t>(slot);
+        read->len = static_cast<unsigned>(readLength(sizes[i]));
+        read->off = 0;
+        read->buf_index = 0;
+        read->flags = IOSQE_IO_HARDLINK;
+        read->user_data = i;
+
+        io_uring_sqe* close = nextSqe(tail);
+        close->opcode = IORING_OP_CLOSE;
+        close->fd = fds[i];
+        close->user_data = kCloseTag | i;
+        queued += 2;
+    }
+    ok = run(tail, queued, [&](uint64_t tag, int result) {
+        if (tag & kCloseTag) {
+            // A cancelled close never ran
+            closed[tag & ~kCloseTag] = result != -ECANCELED;
+            return;
+        }
+        files[tag].data = slots.data() + tag * kSlotSize;
+        files[tag].size = result > 0 ? static_cast<size_t>(result) : 0;
+        files[tag].loaded = result >= 0 && static_cast<size_t>(result) == sizes[tag];
+    });
+    // Files whose close was never submitted (or was cancelled) are closed
+    // here, so a failed batch leaks no descriptors. After giving up on
+    // the ring a close may still be pending, and a second one could hit a
+    // reused descriptor, so those are left open.
+    for (size_t i = 0; i < paths.size() && !abandoned; i++) {
+        if (fds[i] >= 0 && !closed[i]) {
+            ::close(fds[i]);
+        }
+    }
+    if (!ok) {
+        // Nothing is in flight any more; the batch is read again the plain
+        // way, without the ring
+        closeRing();
+        for (LoadedFile& file : files) {
+            file.loaded = false;
+        }
+    }
+    return ok;
+}
+
+#else
+
+bool FileBatchReader::setupRing() {
+    return false;
+}
+
+void FileBatchReader::closeRing() {}
+
+bool FileBatchReader::loadWithRing(const std::vector<std::string>&, const std::vector<size_t>&,
+                                   std::vector<LoadedFile>&) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef GITHUB_MANAGER_FILE_BATCH_H
+#define GITHUB_MANAGER_FILE_BATCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// A file loaded by FileBatchReader. data stays valid until the next load().
+struct LoadedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+    bool loaded = false;
+};
+
+// Loads batches of small files into fixed slots of one buffer, so a
+// directory walk does not pay an open/read/close round trip per file.
+//
+// With io_uring, the opens of a batch are submitted together, then each
+// file's read (into a registered buffer slot) chained to its close, so a
+// batch of 64 files costs two io_uring_enter calls and the reads of cold
+// files are in flight concurrently. Kernels without io_uring (or where it
+// is disabled or lacks the needed operations) get plain open/pread/close.
+//
+// A file is only marked loaded if exactly the expected number of bytes
+// was read; anything else (a file that changed since it was listed, a
+// read error) is left for the caller to read the ordinary way.
+class FileBatchReader {
+public:
+    static constexpr size_t kSlotSize = 128 * 1024;
+    static constexpr size_t kMaxFiles = 64;
+
+    explicit FileBatchReader(bool useIoUring);
+    FileBatchReader(const FileBatchReader&) = delete;
+    FileBatchReader& operator=(const FileBatchReader&) = delete;
+    ~FileBatchReader();
+
+    bool usingIoUring() const { return ring >= 0; }
+
+    // Loads up to kMaxFiles files, each expected to hold sizes[i] bytes
+    // (at most kSlotSize).
+    void load(const std::vector<std::string>& paths, const std::vector<size_t>& sizes,
+              std::vector<LoadedFile>& files);
+
+private:
+    bool setupRing();
+    void closeRing();
+    bool loadWithRing(const std::vector<std::string>& paths, const std::vector<size_t>& sizes,
+                      std::vector<LoadedFile>& files);
+    void loadWithPread(const std::vector<std::string>& paths, const std::vector<size_t>& sizes,
+                       std::vector<LoadedFile>& files);
+
+    std::vector<char> slots;
+    bool buffersRegistered = false;
+
+    // io_uring state, mapped from the kernel
+    int ring = -1;
+    void* sqMap = nullptr;
+    size_t sqMapSize = 0;
+    void* cqMap = nullptr;
+    size_t cqMapSize = 0;
+    void* sqeMap = nullptr;
+    size_t sqeMapSize = 0;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    void* cqes = nullptr;
+};
+
+#endif
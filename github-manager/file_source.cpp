@@ -0,0 +1,126 @@
+#include "file_source.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Mapped pages behind the cursor are released in steps of this size
+const unsigned long long kReleaseStep = 8 * 1024 * 1024;
+
+}
+
+FileSource::FileSource(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        fd = -1;
+        return;
+    }
+    fileSize = static_cast<unsigned long long>(info.st_size);
+
+    if (fileSize >= kMapThreshold) {
+        void* address = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            map = static_cast<char*>(address);
+            ::madvise(map, fileSize, MADV_SEQUENTIAL);
+            return;
+        }
+        // Fall back to reading
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    buffer.resize(kReadChunk);
+}
+
+FileSource::~FileSource() {
+    if (map) {
+        ::munmap(map, fileSize);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool FileSource::next(const char*& data, size_t& length, size_t maxLength) {
+    if (fd < 0 || error || position >= fileSize || maxLength == 0) {
+        return false;
+    }
+
+    if (map) {
+        // Drop what was consumed; it is read back from the page cache if
+        // a retry needs it
+        if (position > released && position - released >= 2 * kReleaseStep) {
+            unsigned long long upTo = (position - kReleaseStep) & ~(kReleaseStep - 1);
+            ::madvise(map + released, upTo - released, MADV_DONTNEED);
+            released = upTo;
+        }
+        length = static_cast<size_t>(std::min<unsigned long long>(maxLength, fileSize - position));
+        data = map + position;
+        position += length;
+        return true;
+    }
+
+    size_t wanted = static_cast<size_t>(
+        std::min<unsigned long long>(std::min(maxLength, buffer.size()), fileSize - position));
+    ssize_t n;
+    do {
+        n = ::pread(fd, buffer.data(), wanted, static_cast<off_t>(position));
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        // Error, or the file got shorter than announced
+        error = true;
+        return false;
+    }
+    data = buffer.data();
+    length = static_cast<size_t>(n);
+    position += length;
+    return true;
+}
+
+bool FileSource::rewind() {
+    if (fd < 0) {
+        return false;
+    }
+    // Released pages fault back in from the page cache on the next pass
+    position = 0;
+    released = 0;
+    error = false;
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& content) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    // Straight into the string; no intermediate buffer
+    content.resize(static_cast<size_t>(info.st_size));
+    size_t at = 0;
+    while (at < content.size()) {
+        ssize_t n = ::pread(fd, &content[at], content.size() - at, static_cast<off_t>(at));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        at += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    return at == content.size();
+}
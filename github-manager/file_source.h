@@ -0,0 +1,59 @@
+#ifndef GITHUB_MANAGER_FILE_SOURCE_H
+#define GITHUB_MANAGER_FILE_SOURCE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Sequential read access to a file, handed out as spans that consumers
+// (base64 encoder, hashers, scanners) use in place.
+//
+// Files of kMapThreshold bytes or more are mapped with MADV_SEQUENTIAL,
+// so their spans point straight into the page cache and nothing is
+// copied; pages already handed out are dropped from the mapping as the
+// cursor moves on, which keeps resident memory flat for any file size.
+// Smaller files are read with pread into one reusable buffer, which is
+// cheaper than setting up a mapping.
+//
+// The size is taken when the file is opened. A file that shrinks while
+// being read is reported through failed() in pread mode; a mapped one
+// must not be truncated underneath us (the access would fault).
+class FileSource {
+public:
+    static const size_t kMapThreshold = 1024 * 1024;
+    static const size_t kReadChunk = 64 * 1024;     // span size when reading
+    static const size_t kMappedSpan = 1024 * 1024;  // span size when mapped
+
+    explicit FileSource(const std::string& path);
+    FileSource(const FileSource&) = delete;
+    FileSource& operator=(const FileSource&) = delete;
+    ~FileSource();
+
+    bool isOpen() const { return fd >= 0; }
+    unsigned long long size() const { return fileSize; }
+    bool mapped() const { return map != nullptr; }
+
+    // Sets data/length to the next span of at most maxLength bytes. False
+    // at the end of the file or on error.
+    bool next(const char*& data, size_t& length, size_t maxLength = kMappedSpan);
+
+    // Back to the first byte, for retries.
+    bool rewind();
+
+    bool failed() const { return error; }
+
+private:
+    int fd = -1;
+    unsigned long long fileSize = 0;
+    unsigned long long position = 0;
+    char* map = nullptr;
+    unsigned long long released = 0;   // mapped bytes already dropped
+    std::vector<char> buffer;
+    bool error = false;
+};
+
+// Reads the whole file into content; false if it cannot be read or its
+// size changed meanwhile.
+bool readFile(const std::string& path, std::string& content);
+
+#endif
@@ -0,0 +1,171 @@
+#include "git_blob.h"
+
+#include <filesystem>
+#include <memory>
+#include <system_error>
+#include <vector>
+#include <openssl/evp.h>
+#include "file_source.h"
+#include "sha1_batch.h"
+
+namespace {
+
+// Files up to this size are read whole and hashed side by side; larger
+// ones are streamed on their own
+const std::uintmax_t kBatchLimit = 256 * 1024;
+
+// When contents are also scanned, they are scanned and hashed a group at a
+// time, so each one is still in cache when the SHA-1 kernel reads it. A
+// group holds enough messages to fill the widest kernel's lanes.
+const size_t kGroupFiles = 16;
+const size_t kGroupBytes = 1024 * 1024;
+
+const char kHex[] = "0123456789abcdef";
+
+std::string hexDigest(const unsigned char* digest, size_t length) {
+    std::string id;
+    id.reserve(length * 2);
+    for (size_t i = 0; i < length; i++) {
+        id += kHex[digest[i] >> 4];
+        id += kHex[digest[i] & 0x0f];
+    }
+    return id;
+}
+
+struct DigestDeleter {
+    void operator()(EVP_MD_CTX* context) const { EVP_MD_CTX_free(context); }
+};
+
+std::unique_ptr<EVP_MD_CTX, DigestDeleter> startBlob(unsigned long long size) {
+    std::unique_ptr<EVP_MD_CTX, DigestDeleter> context(EVP_MD_CTX_new());
+    if (!context || !EVP_DigestInit_ex(context.get(), EVP_sha1(), nullptr)) {
+        return nullptr;
+    }
+    std::string header = "blob " + std::to_string(size);
+    // The header's NUL terminator is part of the hashed data
+    EVP_DigestUpdate(context.get(), header.c_str(), header.size() + 1);
+    return context;
+}
+
+std::string finishBlob(EVP_MD_CTX* context) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    if (!EVP_DigestFinal_ex(context, digest, &length)) {
+        return "";
+    }
+    return hexDigest(digest, length);
+}
+
+}
+
+bool gitBlobId(const std::string& path, std::string& id, ContentProfile* profile) {
+    FileSource source(path);
+    if (!source.isOpen()) {
+        return false;
+    }
+
+    auto context = startBlob(source.size());
+    ContentScanner scanner;
+    const char* data;
+    size_t length;
+    while (context && source.next(data, length)) {
+        if (profile) {
+            scanner.update(data, length);
+        }
+        EVP_DigestUpdate(context.get(), data, length);
+    }
+    if (profile) {
+        *profile = scanner.finish();
+    }
+
+    // A file that changed size while being read would hash a bogus header
+    if (!context || source.failed()) {
+        return false;
+    }
+    id = finishBlob(context.get());
+    return !id.empty();
+}
+
+std::string gitBlobId(const void* data, size_t size) {
+    auto context = startBlob(size);
+    if (!context) {
+        return "";
+    }
+    EVP_DigestUpdate(context.get(), data, size);
+    return finishBlob(context.get());
+}
+
+void gitBlobIds(const std::vector<std::string>& paths, std::vector<std::string>& ids,
+                std::vector<ContentProfile>* profiles) {
+    ids.assign(paths.size(), "");
+    if (profiles) {
+        profiles->assign(paths.size(), ContentProfile());
+    }
+
+    std::vector<std::string> contents(paths.size());
+    std::vector<std::string_view> views;
+    std::vector<size_t> owners;
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::error_code ec;
+        std::uintmax_t size = std::filesystem::file_size(paths[i], ec);
+        if (ec) {
+            continue;
+        }
+        if (size > kBatchLimit) {
+            gitBlobId(paths[i], ids[i], profiles ? &(*profiles)[i] : nullptr);
+            continue;
+        }
+        if (readFile(paths[i], contents[i])) {
+            views.push_back(contents[i]);
+            owners.push_back(i);
+        }
+    }
+
+    std::vector<std::string> batchIds;
+    std::vector<ContentProfile> batchProfiles;
+    gitBlobIds(views, batchIds, profiles ? &batchProfiles : nullptr);
+    for (size_t j = 0; j < owners.size(); j++) {
+        ids[owners[j]] = std::move(batchIds[j]);
+        if (profiles) {
+            (*profiles)[owners[j]] = batchProfiles[j];
+        }
+    }
+}
+
+void gitBlobIds(const std::vector<std::string_view>& contents, std::vector<std::string>& ids,
+                std::vector<ContentProfile>* profiles) {
+    std::vector<std::string> headers(contents.size());
+    std::vector<Sha1Job> jobs(contents.size());
+    for (size_t i = 0; i < contents.size(); i++) {
+        headers[i] = "blob " + std::to_string(contents[i].size());
+        jobs[i].prefix = headers[i].c_str();
+        jobs[i].prefixSize = headers[i].size() + 1;
+        jobs[i].data = contents[i].data();
+        jobs[i].size = contents[i].size();
+    }
+
+    if (!profiles) {
+        sha1Batch(jobs.data(), jobs.size());
+    } else {
+        profiles->assign(contents.size(), ContentProfile());
+        ContentScanner scanner;
+        for (size_t first = 0; first < jobs.size();) {
+            size_t last = first;
+            size_t bytes = 0;
+            while (last < jobs.size() && last - first < kGroupFiles &&
+                   (last == first || bytes + jobs[last].size <= kGroupBytes)) {
+                scanner.reset();
+                scanner.update(jobs[last].data, jobs[last].size);
+                (*profiles)[last] = scanner.finish();
+                bytes += jobs[last].size;
+                last++;
+            }
+            sha1Batch(jobs.data() + first, last - first);
+            first = last;
+        }
+    }
+    ids.resize(contents.size());
+    for (size_t i = 0; i < jobs.size(); i++) {
+        ids[i] = hexDigest(jobs[i].digest, sizeof(jobs[i].digest));
+    }
+}
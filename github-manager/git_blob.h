@@ -0,0 +1,31 @@
+#ifndef GITHUB_MANAGER_GIT_BLOB_H
+#define GITHUB_MANAGER_GIT_BLOB_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "content_scan.h"
+
+// Object id git assigns to a file's content: the SHA-1 of
+// "blob <size>\0" followed by the content, in lowercase hex. The GitHub
+// API reports the same id as "sha" for files and tree entries, so equal
+// ids mean equal content.
+//
+// With a profile, the content also goes through a ContentScanner on the
+// same read, so a file that is both compared and classified is read once.
+bool gitBlobId(const std::string& path, std::string& id, ContentProfile* profile = nullptr);
+
+std::string gitBlobId(const void* data, size_t size);
+
+// Blob ids of many files at once, hashed together by sha1Batch; ids[i] is
+// left empty when paths[i] cannot be read. profiles, if given, receives
+// each file's ContentProfile (valid where ids[i] is not empty).
+void gitBlobIds(const std::vector<std::string>& paths, std::vector<std::string>& ids,
+                std::vector<ContentProfile>* profiles = nullptr);
+
+// Same for contents already in memory.
+void gitBlobIds(const std::vector<std::string_view>& contents, std::vector<std::string>& ids,
+                std::vector<ContentProfile>* profiles = nullptr);
+
+#endif
@@ -0,0 +1,160 @@
+#include "http_transport.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+bool usesSink(const HttpResponse& response) {
+    return response.sink && response.status >= 200 && response.status < 300;
+}
+
+size_t appendBody(void* contents, size_t size, size_t nmemb, void* userp) {
+    size_t totalSize = size * nmemb;
+    HttpResponse* response = static_cast<HttpResponse*>(userp);
+    const char* data = static_cast<const char*>(contents);
+    response->decodedBytes += static_cast<long long>(totalSize);
+
+    if (usesSink(*response)) {
+        response->sinkBytes += static_cast<long long>(totalSize);
+        return response->sink->write(data, totalSize) ? totalSize : 0;
+    }
+    response->body.append(data, totalSize);
+    return totalSize;
+}
+
+size_t appendHeader(char* buffer, size_t size, size_t nitems, void* userp) {
+    size_t totalSize = size * nitems;
+    HttpResponse* response = static_cast<HttpResponse*>(userp);
+    std::string line(buffer, totalSize);
+
+    // A new status line starts a new header block (redirects, 100 Continue)
+    if (line.compare(0, 5, "HTTP/") == 0) {
+        response->headers.clear();
+        size_t space = line.find(' ');
+        response->status = space == std::string::npos ? 0 : std::atol(line.c_str() + space + 1);
+        return totalSize;
+    }
+
+    // The blank line ends the block; let the body's destination size itself
+    if (line == "\r\n" || line == "\n") {
+        std::string length = response->header("content-length");
+        if (!length.empty() && response->status >= 200) {
+            long long contentLength = std::atoll(length.c_str());
+            if (usesSink(*response)) {
+                response->sink->expect(contentLength);
+            } else {
+                StringSink(response->body).expect(contentLength);
+            }
+        }
+        return totalSize;
+    }
+
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+        return totalSize;
+    }
+
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    size_t begin = line.find_first_not_of(" \t", colon + 1);
+    size_t end = line.find_last_not_of(" \t\r\n");
+    response->headers[name] = (begin == std::string::npos || end < begin)
+                                  ? ""
+                                  : line.substr(begin, end - begin + 1);
+    return totalSize;
+}
+
+}
+
+std::string HttpResponse::header(const std::string& name) const {
+    auto it = headers.find(name);
+    return it == headers.end() ? "" : it->second;
+}
+
+void captureResponse(CURL* curl, HttpResponse& response) {
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, appendHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response);
+}
+
+void completeResponse(CURL* curl, CURLcode result, HttpResponse& response) {
+    response.result = result;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+
+    // Counted before content decoding, i.e. what actually crossed the wire
+    curl_off_t downloaded = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded) == CURLE_OK) {
+        response.wireBytes = downloaded;
+    }
+}
+
+std::string supportedEncodings() {
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    std::string encodings;
+    if (!info) {
+        return encodings;
+    }
+
+    auto add = [&encodings](const char* name) {
+        encodings += encodings.empty() ? name : std::string(", ") + name;
+    };
+    if (info->features & CURL_VERSION_LIBZ) {
+        add("gzip");
+        add("deflate");
+    }
+#ifdef CURL_VERSION_BROTLI
+    if (info->features & CURL_VERSION_BROTLI) {
+        add("br");
+    }
+#endif
+#ifdef CURL_VERSION_ZSTD
+    if (info->features & CURL_VERSION_ZSTD) {
+        add("zstd");
+    }
+#endif
+    return encodings;
+}
+
+bool http2Supported() {
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    return info && (info->features & CURL_VERSION_HTTP2);
+}
+
+void applyTransportOptions(CURL* curl, const TransportOptions& options,
+                           const std::string& url) {
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    if (options.compression) {
+        // An empty string lets libcurl list all encodings it was built with
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    }
+    if (!options.caInfo.empty()) {
+        curl_easy_setopt(curl, CURLOPT_CAINFO, options.caInfo.c_str());
+    }
+
+    if (!options.http2 || url.compare(0, 8, "https://") != 0) {
+        return;
+    }
+
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    // Wait for an existing connection to multiplex on rather than opening more
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+}
+
+void applyTransportOptions(CURLM* multi, const TransportOptions& options) {
+    if (!options.http2) {
+        return;
+    }
+
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, 1L);
+    curl_multi_setopt(multi, CURLMOPT_MAX_CONCURRENT_STREAMS, options.maxConcurrentStreams);
+}
+
+void allowParallelConnections(CURLM* multi) {
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, 0L);
+}
@@ -0,0 +1,69 @@
+#ifndef GITHUB_MANAGER_HTTP_TRANSPORT_H
+#define GITHUB_MANAGER_HTTP_TRANSPORT_H
+
+#include <map>
+#include <string>
+#include <curl/curl.h>
+#include "response_sink.h"
+
+// Protocol-level settings shared by every request the client makes.
+struct TransportOptions {
+    // Multiplex requests over one HTTP/2 connection per host. The version is
+    // negotiated via ALPN and falls back to HTTP/1.1; plain http endpoints
+    // always use HTTP/1.1.
+    bool http2 = false;
+    // Upper bound on concurrent streams on a multiplexed connection.
+    long maxConcurrentStreams = 100;
+    // CA bundle for endpoints with a private CA (GitHub Enterprise, stand-ins).
+    std::string caInfo;
+    // Advertise every content encoding libcurl can decode (gzip, deflate and,
+    // depending on the build, br and zstd) and decompress while streaming.
+    bool compression = true;
+};
+
+// Status, headers and body of a finished request.
+//
+// Successful (2xx) bodies go to sink when one is set and to body otherwise.
+// Error bodies always land in body, where diagnostics and the rate limiter
+// can read them.
+struct HttpResponse {
+    CURLcode result = CURLE_OK;
+    long status = 0;
+    std::map<std::string, std::string> headers;   // names lower-cased
+    std::string body;
+    ResponseSink* sink = nullptr;
+    bool fromCache = false;   // 304 answered from the response cache
+    long long wireBytes = 0;      // body bytes as received, possibly compressed
+    long long decodedBytes = 0;   // body bytes after content decoding
+    long long sinkBytes = 0;      // of those, bytes handed to sink
+
+    bool succeeded() const { return result == CURLE_OK && status >= 200 && status < 300; }
+    // Value of a response header, or "" if absent. Name must be lower-case.
+    std::string header(const std::string& name) const;
+};
+
+// Routes the status, headers and body of the next transfer on this handle
+// into response. The response (and its sink) must outlive the transfer.
+void captureResponse(CURL* curl, HttpResponse& response);
+
+// Records the transfer result and HTTP status once the transfer is done.
+void completeResponse(CURL* curl, CURLcode result, HttpResponse& response);
+
+// Content encodings the linked libcurl can decode, e.g. "gzip, deflate, br".
+std::string supportedEncodings();
+
+// True if the linked libcurl was built with HTTP/2 support.
+bool http2Supported();
+
+// Applies keep-alive, compression and HTTP version settings to an easy handle.
+void applyTransportOptions(CURL* curl, const TransportOptions& options,
+                           const std::string& url);
+
+// Applies multiplexing limits to a multi handle.
+void applyTransportOptions(CURLM* multi, const TransportOptions& options);
+
+// Lifts the one-connection-per-host limit once a server turned out not to
+// speak HTTP/2, so HTTP/1.1 transfers are not serialized behind each other.
+void allowParallelConnections(CURLM* multi);
+
+#endif
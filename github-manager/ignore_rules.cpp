@@ -0,0 +1,289 @@
+#include "ignore_rules.h"
+
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+const char* const kGlobCharacters = "*?[\\";
+
+bool classMember(const char* name, size_t length, unsigned char c) {
+    struct Class {
+        const char* name;
+        int (*test)(int);
+    };
+    static const Class kClasses[] = {
+        {"alnum", isalnum}, {"alpha", isalpha}, {"blank", isblank}, {"cntrl", iscntrl},
+        {"digit", isdigit}, {"graph", isgraph}, {"lower", islower}, {"print", isprint},
+        {"punct", ispunct}, {"space", isspace}, {"upper", isupper}, {"xdigit", isxdigit},
+    };
+    for (const Class& entry : kClasses) {
+        if (std::strlen(entry.name) == length && std::memcmp(entry.name, name, length) == 0) {
+            return entry.test(c) != 0;
+        }
+    }
+    return false;
+}
+
+// The bracket expression starting at pattern[p]. Returns 1 or 0 for
+// whether c is in it and sets end past the closing ], or -1 if there is
+// no closing ] (the [ is then an ordinary character).
+int matchClass(std::string_view pattern, size_t p, char c, size_t& end) {
+    size_t i = p + 1;
+    bool negated = i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^');
+    if (negated) {
+        i++;
+    }
+    unsigned char u = static_cast<unsigned char>(c);
+    bool found = false;
+    bool first = true;
+    while (i < pattern.size() && (pattern[i] != ']' || first)) {
+        first = false;
+        if (pattern[i] == '[' && i + 1 < pattern.size() && pattern[i + 1] == ':') {
+            size_t close = pattern.find(":]", i + 2);
+            if (close != std::string_view::npos) {
+                found = found || classMember(pattern.data() + i + 2, close - i - 2, u);
+                i = close + 2;
+                continue;
+            }
+        }
+        unsigned char low = static_cast<unsigned char>(pattern[i]);
+        if (low == '\\' && i + 1 < pattern.size()) {
+            low = static_cast<unsigned char>(pattern[++i]);
+        }
+        i++;
+        unsigned char high = low;
+        if (i + 1 < pattern.size() && pattern[i] == '-' && pattern[i + 1] != ']') {
+            high = static_cast<unsigned char>(pattern[i + 1]);
+            if (high == '\\' && i + 2 < pattern.size()) {
+                high = static_cast<unsigned char>(pattern[i + 2]);
+                i++;
+            }
+            i += 2;
+        }
+        found = found || (u >= low && u <= high);
+    }
+    if (i >= pattern.size()) {
+        return -1;
+    }
+    end = i + 1;
+    return found != negated ? 1 : 0;
+}
+
+bool matchFrom(std::string_view pattern, size_t p, std::string_view text, size_t t) {
+    while (p < pattern.size()) {
+        char c = pattern[p];
+        if (c == '*') {
+            size_t after = p + 1;
+            while (after < pattern.size() && pattern[after] == '*') {
+                after++;
+            }
+            bool wholeComponent = after - p > 1 && (p == 0 || pattern[p - 1] == '/');
+            if (wholeComponent && after == pattern.size()) {
+                // Trailing **: everything below
+                return true;
+            }
+            if (wholeComponent && pattern[after] == '/') {
+                // **/: zero or more directories
+                for (size_t s = t;;) {
+                    if (matchFrom(pattern, after + 1, text, s)) {
+                        return true;
+                    }
+                    size_t slash = text.find('/', s);
+                    if (slash == std::string_view::npos) {
+                        return false;
+                    }
+                    s = slash + 1;
+                }
+            }
+
+            // Anywhere else, any run of characters within one component
+            p = after;
+            if (p == pattern.size()) {
+                return text.find('/', t) == std::string_view::npos;
+            }
+            for (size_t s = t;; s++) {
+                if (matchFrom(pattern, p, text, s)) {
+                    return true;
+                }
+                if (s == text.size() || text[s] == '/') {
+                    return false;
+                }
+            }
+        }
+
+        if (t == text.size()) {
+            return false;
+        }
+        if (c == '?') {
+            if (text[t] == '/') {
+                return false;
+            }
+            p++;
+            t++;
+            continue;
+        }
+        if (c == '[') {
+            size_t end;
+            int member = matchClass(pattern, p, text[t], end);
+            if (member >= 0) {
+                if (member == 0 || text[t] == '/') {
+                    return false;
+                }
+                p = end;
+                t++;
+                continue;
+            }
+        }
+        if (c == '\\' && p + 1 < pattern.size()) {
+            c = pattern[++p];
+        }
+        if (text[t] != c) {
+            return false;
+        }
+        p++;
+        t++;
+    }
+    return t == text.size();
+}
+
+std::string_view extension(std::string_view name) {
+    size_t dot = name.rfind('.');
+    return dot == std::string_view::npos ? std::string_view() : name.substr(dot);
+}
+
+}
+
+bool globMatch(std::string_view pattern, std::string_view text) {
+    return matchFrom(pattern, 0, text, 0);
+}
+
+void IgnoreRules::parse(std::string_view text) {
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        add(text.substr(0, newline));
+        if (newline == std::string_view::npos) {
+            break;
+        }
+        text.remove_prefix(newline + 1);
+    }
+}
+
+void IgnoreRules::add(std::string_view pattern) {
+    if (!pattern.empty() && pattern.back() == '\r') {
+        pattern.remove_suffix(1);
+    }
+    if (pattern.empty() || pattern[0] == '#') {
+        return;
+    }
+    // Trailing spaces go unless escaped
+    while (!pattern.empty() && pattern.back() == ' ' &&
+           !(pattern.size() >= 2 && pattern[pattern.size() - 2] == '\\')) {
+        pattern.remove_suffix(1);
+    }
+
+    bool negated = !pattern.empty() && pattern[0] == '!';
+    if (negated) {
+        pattern.remove_prefix(1);
+    }
+    bool directoryOnly = !pattern.empty() && pattern.back() == '/';
+    if (directoryOnly) {
+        pattern.remove_suffix(1);
+    }
+    bool anchored = pattern.find('/') != std::string_view::npos;
+    if (!pattern.empty() && pattern[0] == '/') {
+        pattern.remove_prefix(1);
+    }
+    if (pattern.empty()) {
+        return;
+    }
+
+    int index = count++;
+    size_t special = pattern.find_first_of(kGlobCharacters);
+    if (!anchored && special == std::string_view::npos) {
+        strings.emplace_back(pattern);
+        Literal& literal = literals[strings.back()];
+        if (directoryOnly) {
+            literal.directoryIndex = index;
+            literal.directoryNegated = negated;
+        } else {
+            literal.index = index;
+            literal.negated = negated;
+        }
+        return;
+    }
+
+    std::string_view rest = pattern.substr(1);
+    if (!anchored && special == 0 && pattern[0] == '*' && !rest.empty() &&
+        rest.find_first_of(kGlobCharacters) == std::string_view::npos &&
+        !extension(rest).empty()) {
+        strings.emplace_back(rest);
+        std::string_view suffix = strings.back();
+        suffixes[extension(suffix)].push_back(Suffix{suffix, directoryOnly, negated, index});
+        return;
+    }
+
+    Rule rule;
+    rule.pattern = std::string(pattern);
+    rule.prefix = special == std::string_view::npos ? pattern.size() : special;
+    rule.anchored = anchored;
+    rule.directoryOnly = directoryOnly;
+    rule.negated = negated;
+    rule.index = index;
+    globs.push_back(std::move(rule));
+}
+
+IgnoreRules::Match IgnoreRules::match(std::string_view path, std::string_view name,
+                                      bool directory) const {
+    int best = -1;
+    bool negated = false;
+    auto consider = [&](int index, bool ruleNegated) {
+        if (index > best) {
+            best = index;
+            negated = ruleNegated;
+        }
+    };
+
+    auto literal = literals.find(name);
+    if (literal != literals.end()) {
+        consider(literal->second.index, literal->second.negated);
+        if (directory) {
+            consider(literal->second.directoryIndex, literal->second.directoryNegated);
+        }
+    }
+
+    std::string_view ext = extension(name);
+    if (!ext.empty()) {
+        auto bucket = suffixes.find(ext);
+        if (bucket != suffixes.end()) {
+            for (const Suffix& suffix : bucket->second) {
+                if ((directory || !suffix.directoryOnly) && name.size() >= suffix.suffix.size() &&
+                    name.compare(name.size() - suffix.suffix.size(), std::string_view::npos,
+                                 suffix.suffix) == 0) {
+                    consider(suffix.index, suffix.negated);
+                }
+            }
+        }
+    }
+
+    // Newest first, so the search stops at the first match or once only
+    // rules older than one already found are left
+    for (auto rule = globs.rbegin(); rule != globs.rend() && rule->index > best; ++rule) {
+        if (rule->directoryOnly && !directory) {
+            continue;
+        }
+        std::string_view text = rule->anchored ? path : name;
+        if (text.compare(0, rule->prefix, rule->pattern, 0, rule->prefix) != 0) {
+            continue;
+        }
+        if (globMatch(rule->pattern, text)) {
+            consider(rule->index, rule->negated);
+            break;
+        }
+    }
+
+    if (best < 0) {
+        return kNone;
+    }
+    return negated ? kIncluded : kIgnored;
+}
@@ -0,0 +1,76 @@
+#ifndef GITHUB_MANAGER_IGNORE_RULES_H
+#define GITHUB_MANAGER_IGNORE_RULES_H
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// The patterns of one .gitignore file (or of .git/info/exclude, or of the
+// --exclude options), compiled for matching many paths.
+//
+// gitignore syntax: blank lines and # comments are skipped, ! negates, a
+// trailing / matches directories only, a pattern with a / in it is
+// anchored to the directory of the file (otherwise it matches the name at
+// any depth), and *, ?, [...] and ** glob as git does. The last matching
+// pattern decides.
+//
+// Plain names ("node_modules", "Thumbs.db") are looked up in a hash
+// table and "*.ext" patterns by extension, which covers most real ignore
+// files; only the rest go through the glob matcher, after a check of
+// their literal prefix.
+class IgnoreRules {
+public:
+    enum Match { kNone, kIgnored, kIncluded };
+
+    IgnoreRules() = default;
+    IgnoreRules(IgnoreRules&&) = default;
+    IgnoreRules& operator=(IgnoreRules&&) = default;
+    // The lookup tables point into strings
+    IgnoreRules(const IgnoreRules&) = delete;
+    IgnoreRules& operator=(const IgnoreRules&) = delete;
+
+    void parse(std::string_view text);
+    void add(std::string_view pattern);
+    bool empty() const { return count == 0; }
+
+    // path is relative to the directory the patterns came from, '/'
+    // separated; name is its last component.
+    Match match(std::string_view path, std::string_view name, bool directory) const;
+
+private:
+    struct Rule {
+        std::string pattern;
+        size_t prefix;         // length of the literal start of pattern
+        bool anchored;
+        bool directoryOnly;
+        bool negated;
+        int index;
+    };
+    struct Suffix {
+        std::string_view suffix;
+        bool directoryOnly;
+        bool negated;
+        int index;
+    };
+    struct Literal {
+        int index = -1;        // highest matching rule for any entry
+        bool negated = false;
+        int directoryIndex = -1;   // highest rule for directories only
+        bool directoryNegated = false;
+    };
+
+    int count = 0;
+    std::deque<std::string> strings;   // stable storage for the keys below
+    std::unordered_map<std::string_view, Literal> literals;
+    std::unordered_map<std::string_view, std::vector<Suffix>> suffixes;   // by extension
+    std::vector<Rule> globs;
+};
+
+// Matches pattern against text with git's wildmatch rules for paths: *
+// and ? stop at /, ** spans directories.
+bool globMatch(std::string_view pattern, std::string_view text);
+
+#endif
@@ -0,0 +1,374 @@
+#include "json_dom.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+const JsonValue kNull;
+
+// Deeper documents are rejected rather than risking the stack
+const int kMaxDepth = 512;
+
+class Parser {
+public:
+    Parser(const std::string& text, JsonArena& _arena)
+        : p(text.data()), end(text.data() + text.size()), arena(_arena) {}
+
+    bool parseDocument(JsonValue& root, size_t& values) {
+        if (!parseValue(root, 0)) {
+            return false;
+        }
+        skipSpace();
+        values = parsed;
+        return p == end;
+    }
+
+    // Heap allocations made by the parse stacks, and their final size
+    size_t stackAllocations() const { return stackGrowths; }
+    size_t stackBytes() const {
+        return valueStack.capacity() * sizeof(JsonValue) +
+               keyStack.capacity() * sizeof(std::string_view);
+    }
+
+private:
+    const char* p;
+    const char* end;
+    JsonArena& arena;
+    size_t parsed = 0;
+
+    // Children of the containers still open, in document order. A closed
+    // container copies its run into the arena and pops it, so these grow to
+    // the widest nesting seen and are then reused.
+    std::vector<JsonValue> valueStack;
+    std::vector<std::string_view> keyStack;
+    size_t stackGrowths = 0;
+
+    // push_back, counting the reallocations so the statistics cover every
+    // heap allocation of a parse, not only the arena's
+    template <typename T>
+    void push(std::vector<T>& stack, const T& item) {
+        if (stack.size() == stack.capacity()) {
+            stackGrowths++;
+        }
+        stack.push_back(item);
+    }
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            p++;
+        }
+    }
+
+    bool literal(const char* word, size_t length) {
+        if (static_cast<size_t>(end - p) < length || std::memcmp(p, word, length) != 0) {
+            return false;
+        }
+        p += length;
+        return true;
+    }
+
+    template <typename T>
+    T* copyOut(const T* first, size_t count) {
+        if (count == 0) {
+            return nullptr;
+        }
+        T* target = static_cast<T*>(arena.allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; i++) {
+            new (&target[i]) T(first[i]);
+        }
+        return target;
+    }
+
+    static bool hex4(const char* at, uint32_t& code) {
+        code = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = at[i];
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static char* putUtf8(char* out, uint32_t code) {
+        if (code < 0x80) {
+            *out++ = static_cast<char>(code);
+        } else if (code < 0x800) {
+            *out++ = static_cast<char>(0xc0 | (code >> 6));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+        } else if (code < 0x10000) {
+            *out++ = static_cast<char>(0xe0 | (code >> 12));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+        } else {
+            *out++ = static_cast<char>(0xf0 | (code >> 18));
+            *out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+        }
+        return out;
+    }
+
+    // Parses the string p points at. Without escapes the result is a view
+    // into the text; otherwise it is unescaped into the arena, which never
+    // needs more room than the escaped form.
+    bool parseString(std::string_view& result) {
+        const char* begin = ++p;
+        bool escaped = false;
+        while (p < end && *p != '"') {
+            if (*p == '\\') {
+                escaped = true;
+                p++;
+            } else if (static_cast<unsigned char>(*p) < 0x20) {
+                return false;
+            }
+            p++;
+        }
+        if (p >= end) {
+            return false;
+        }
+        const char* stop = p++;
+
+        if (!escaped) {
+            result = std::string_view(begin, stop - begin);
+            return true;
+        }
+
+        char* out = static_cast<char*>(arena.allocate(stop - begin, 1));
+        char* at = out;
+        for (const char* in = begin; in < stop; in++) {
+            if (*in != '\\') {
+                *at++ = *in;
+                continue;
+            }
+            switch (*++in) {
+                case '"': *at++ = '"'; break;
+                case '\\': *at++ = '\\'; break;
+                case '/': *at++ = '/'; break;
+                case 'b': *at++ = '\b'; break;
+                case 'f': *at++ = '\f'; break;
+                case 'n': *at++ = '\n'; break;
+                case 'r': *at++ = '\r'; break;
+                case 't': *at++ = '\t'; break;
+                case 'u': {
+                    uint32_t code;
+                    if (stop - in < 5 || !hex4(in + 1, code)) {
+                        return false;
+                    }
+                    in += 4;
+                    // A high surrogate followed by a low one is one code point
+                    uint32_t low;
+                    if (code >= 0xd800 && code < 0xdc00 && stop - in >= 7 && in[1] == '\\' &&
+                        in[2] == 'u' && hex4(in + 3, low) && low >= 0xdc00 && low < 0xe000) {
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        in += 6;
+                    }
+                    at = putUtf8(at, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        result = std::string_view(out, at - out);
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        skipSpace();
+        if (p >= end || depth > kMaxDepth) {
+            return false;
+        }
+        parsed++;
+
+        switch (*p) {
+            case '{':
+                return parseObject(value, depth);
+            case '[':
+                return parseArray(value, depth);
+            case '"':
+                value.type = JsonValue::Type::String;
+                return parseString(value.text);
+            case 't':
+                value.type = JsonValue::Type::Bool;
+                value.boolean = true;
+                return literal("true", 4);
+            case 'f':
+                value.type = JsonValue::Type::Bool;
+                return literal("false", 5);
+            case 'n':
+                return literal("null", 4);
+            default: {
+                const char* start = p;
+                if (p < end && *p == '-') {
+                    p++;
+                }
+                while (p < end && *p != '\0' && std::strchr("0123456789.eE+-", *p)) {
+                    p++;
+                }
+                if (p == start || (p - start == 1 && *start == '-')) {
+                    return false;
+                }
+                value.type = JsonValue::Type::Number;
+                value.text = std::string_view(start, p - start);
+                return true;
+            }
+        }
+    }
+
+    bool parseArray(JsonValue& value, int depth) {
+        p++;
+        size_t mark = valueStack.size();
+        skipSpace();
+        if (p < end && *p == ']') {
+            p++;
+        } else {
+            while (true) {
+                JsonValue item;
+                if (!parseValue(item, depth + 1)) {
+                    return false;
+                }
+                push(valueStack, item);
+                skipSpace();
+                if (p < end && *p == ',') {
+                    p++;
+                } else if (p < end && *p == ']') {
+                    p++;
+                    break;
+                } else {
+                    return false;
+                }
+            }
+        }
+
+        value.type = JsonValue::Type::Array;
+        value.count = valueStack.size() - mark;
+        value.items = copyOut(valueStack.data() + mark, value.count);
+        valueStack.resize(mark);
+        return true;
+    }
+
+    bool parseObject(JsonValue& value, int depth) {
+        p++;
+        size_t mark = valueStack.size();
+        size_t keyMark = keyStack.size();
+        skipSpace();
+        if (p < end && *p == '}') {
+            p++;
+        } else {
+            while (true) {
+                skipSpace();
+                std::string_view key;
+                if (p >= end || *p != '"' || !parseString(key)) {
+                    return false;
+                }
+                skipSpace();
+                if (p >= end || *p != ':') {
+                    return false;
+                }
+                p++;
+
+                JsonValue member;
+                if (!parseValue(member, depth + 1)) {
+                    return false;
+                }
+                push(keyStack, key);
+                push(valueStack, member);
+                skipSpace();
+                if (p < end && *p == ',') {
+                    p++;
+                } else if (p < end && *p == '}') {
+                    p++;
+                    break;
+                } else {
+                    return false;
+                }
+            }
+        }
+
+        value.type = JsonValue::Type::Object;
+        value.count = valueStack.size() - mark;
+        value.items = copyOut(valueStack.data() + mark, value.count);
+        value.keys = copyOut(keyStack.data() + keyMark, value.count);
+        valueStack.resize(mark);
+        keyStack.resize(keyMark);
+        return true;
+    }
+};
+
+}
+
+JsonArena::~JsonArena() {
+    for (char* block : blocks) {
+        delete[] block;
+    }
+}
+
+void* JsonArena::allocate(size_t size, size_t alignment) {
+    uintptr_t at = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(alignment - 1);
+    if (!cursor || at + size > reinterpret_cast<uintptr_t>(limit)) {
+        // Blocks double up to 1 MB; an oversized request gets its own block
+        size_t blockSize = std::max(nextBlockSize, size + alignment);
+        nextBlockSize = std::min<size_t>(nextBlockSize * 2, 1024 * 1024);
+        char* block = new char[blockSize];
+        blocks.push_back(block);
+        cursor = block;
+        limit = block + blockSize;
+        at = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(alignment - 1);
+    }
+    cursor = reinterpret_cast<char*>(at + size);
+    used += size;
+    return reinterpret_cast<void*>(at);
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const {
+    if (type == Type::Object) {
+        for (size_t i = 0; i < count; i++) {
+            if (keys[i] == key) {
+                return items[i];
+            }
+        }
+    }
+    return kNull;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    if (type == Type::Array && index < count) {
+        return items[index];
+    }
+    return kNull;
+}
+
+long long JsonValue::asInt() const {
+    if (type != Type::Number) {
+        return 0;
+    }
+    long long result = 0;
+    auto parsed = std::from_chars(text.data(), text.data() + text.size(), result);
+    if (parsed.ec != std::errc() || parsed.ptr != text.data() + text.size()) {
+        // Fractions and exponents
+        return static_cast<long long>(std::strtod(std::string(text).c_str(), nullptr));
+    }
+    return result;
+}
+
+bool JsonDocument::parse(const std::string& text) {
+    Parser parser(text, storage);
+    rootValue = JsonValue();
+    bool parsed = parser.parseDocument(rootValue, values);
+    stackAllocations = parser.stackAllocations();
+    stackBytes = parser.stackBytes();
+    return parsed;
+}
@@ -0,0 +1,86 @@
+#ifndef GITHUB_MANAGER_JSON_DOM_H
+#define GITHUB_MANAGER_JSON_DOM_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Monotonic allocator: hands out memory from large blocks and frees all of
+// it at once when destroyed. Nothing is released individually.
+class JsonArena {
+public:
+    JsonArena() = default;
+    JsonArena(const JsonArena&) = delete;
+    JsonArena& operator=(const JsonArena&) = delete;
+    ~JsonArena();
+
+    void* allocate(size_t size, size_t alignment);
+
+    // Heap allocations made so far (one per block)
+    size_t blockCount() const { return blocks.size(); }
+    size_t bytesUsed() const { return used; }
+
+private:
+    std::vector<char*> blocks;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t nextBlockSize = 16 * 1024;
+    size_t used = 0;
+};
+
+// A read-only JSON value. Strings without escapes are views into the
+// parsed text; everything else lives in the document's arena.
+struct JsonValue {
+    enum class Type : unsigned char { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    std::string_view text;                     // string contents or number literal
+    const JsonValue* items = nullptr;          // array elements or member values
+    const std::string_view* keys = nullptr;    // member names, parallel to items
+    size_t count = 0;
+
+    bool isObject() const { return type == Type::Object; }
+    bool isArray() const { return type == Type::Array; }
+    bool isString() const { return type == Type::String; }
+
+    // Member or element lookup; a null value when absent.
+    const JsonValue& operator[](std::string_view key) const;
+    const JsonValue& operator[](size_t index) const;
+
+    // Conversions in the spirit of Json::Value: a default when the type differs.
+    std::string_view asString() const { return type == Type::String ? text : std::string_view(); }
+    bool asBool() const { return type == Type::Bool && boolean; }
+    long long asInt() const;
+
+    // Iterates the elements of an array or the values of an object
+    const JsonValue* begin() const { return items; }
+    const JsonValue* end() const { return items + count; }
+};
+
+// A document parsed in place over text that must outlive it. Freed in one
+// go with its arena.
+class JsonDocument {
+public:
+    bool parse(const std::string& text);
+
+    const JsonValue& root() const { return rootValue; }
+    size_t valueCount() const { return values; }
+    const JsonArena& arena() const { return storage; }
+
+    // Every heap allocation of the last parse: the arena's blocks plus the
+    // growth of the scratch stacks that hold open containers' children
+    size_t allocationCount() const { return storage.blockCount() + stackAllocations; }
+    // Peak size of those scratch stacks, freed when parse() returns
+    size_t scratchBytes() const { return stackBytes; }
+
+private:
+    JsonArena storage;
+    JsonValue rootValue;
+    size_t values = 0;
+    size_t stackAllocations = 0;
+    size_t stackBytes = 0;
+};
+
+#endif
@@ -0,0 +1,485 @@
+#include "json_scan.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <json/json.h>
+
+namespace {
+
+enum class Scan { Found, Missing, Unsupported };
+
+struct Cursor {
+    const char* p;
+    const char* end;
+};
+
+void skipSpace(Cursor& c) {
+    while (c.p < c.end && (*c.p == ' ' || *c.p == '\t' || *c.p == '\n' || *c.p == '\r')) {
+        c.p++;
+    }
+}
+
+// Moves past a string whose opening quote c.p points at. Base64 content
+// makes strings the bulk of most documents, so jump between quotes with
+// memchr rather than stepping through every byte; only strings that have
+// a backslash before their closing quote are looked at more closely, to
+// check their escapes. False if the string is unterminated or has an
+// escape the scanner does not accept (including \u surrogates, which are
+// left to the full parser).
+bool skipString(Cursor& c) {
+    const char* p = c.p + 1;
+    while (p < c.end) {
+        const char* quote = static_cast<const char*>(std::memchr(p, '"', c.end - p));
+        if (!quote) {
+            return false;
+        }
+        const char* backslash = static_cast<const char*>(std::memchr(p, '\\', quote - p));
+        if (!backslash) {
+            c.p = quote + 1;
+            return true;
+        }
+        p = backslash + 1;
+        if (p >= c.end) {
+            return false;
+        }
+        if (*p == 'u') {
+            if (c.end - p < 5) {
+                return false;
+            }
+            unsigned code = 0;
+            for (int i = 1; i <= 4; i++) {
+                char h = p[i];
+                unsigned digit = h >= '0' && h <= '9'   ? h - '0'
+                                 : h >= 'a' && h <= 'f' ? h - 'a' + 10
+                                 : h >= 'A' && h <= 'F' ? h - 'A' + 10
+                                                        : 16;
+                if (digit == 16) {
+                    return false;
+                }
+                code = code * 16 + digit;
+            }
+            if (code >= 0xD800 && code <= 0xDFFF) {
+                return false;
+            }
+            p += 5;
+        } else if (std::strchr("\"\\/bfnrt", *p) && *p != '\0') {
+            p++;
+        } else {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool skipDigits(Cursor& c) {
+    const char* start = c.p;
+    while (c.p < c.end && *c.p >= '0' && *c.p <= '9') {
+        c.p++;
+    }
+    return c.p > start;
+}
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+bool skipNumber(Cursor& c) {
+    if (c.p < c.end && *c.p == '-') {
+        c.p++;
+    }
+    if (c.p < c.end && *c.p == '0') {
+        c.p++;
+    } else if (!skipDigits(c)) {
+        return false;
+    }
+    if (c.p < c.end && *c.p == '.') {
+        c.p++;
+        if (!skipDigits(c)) {
+            return false;
+        }
+    }
+    if (c.p < c.end && (*c.p == 'e' || *c.p == 'E')) {
+        c.p++;
+        if (c.p < c.end && (*c.p == '+' || *c.p == '-')) {
+            c.p++;
+        }
+        if (!skipDigits(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool skipLiteral(Cursor& c, const char* literal) {
+    size_t length = std::strlen(literal);
+    if (static_cast<size_t>(c.end - c.p) < length || std::memcmp(c.p, literal, length) != 0) {
+        return false;
+    }
+    c.p += length;
+    return true;
+}
+
+// Same limit as the full parser's
+const int kMaxDepth = 1000;
+
+// Moves past one value, checking its structure on the way: brackets
+// balance, members are "key": value pairs, elements and members are
+// separated by single commas, and scalars are well formed. False on
+// anything else, so that malformed or truncated text goes to the full
+// parser (which rejects it) rather than being half answered.
+bool skipValue(Cursor& c, int depth) {
+    if (c.p >= c.end) {
+        return false;
+    }
+    switch (*c.p) {
+        case '"':
+            return skipString(c);
+        case 't':
+            return skipLiteral(c, "true");
+        case 'f':
+            return skipLiteral(c, "false");
+        case 'n':
+            return skipLiteral(c, "null");
+        case '{':
+        case '[':
+            break;
+        default:
+            return skipNumber(c);
+    }
+
+    bool object = *c.p == '{';
+    char close = object ? '}' : ']';
+    if (++depth > kMaxDepth) {
+        return false;
+    }
+    c.p++;
+    skipSpace(c);
+    if (c.p < c.end && *c.p == close) {
+        c.p++;
+        return true;
+    }
+    while (true) {
+        if (object) {
+            if (c.p >= c.end || *c.p != '"' || !skipString(c)) {
+                return false;
+            }
+            skipSpace(c);
+            if (c.p >= c.end || *c.p != ':') {
+                return false;
+            }
+            c.p++;
+            skipSpace(c);
+        }
+        if (!skipValue(c, depth)) {
+            return false;
+        }
+        skipSpace(c);
+        if (c.p >= c.end) {
+            return false;
+        }
+        if (*c.p == close) {
+            c.p++;
+            return true;
+        }
+        if (*c.p != ',') {
+            return false;
+        }
+        c.p++;
+        skipSpace(c);
+    }
+}
+
+// An object or array on the path to the requested value, still open
+struct Level {
+    bool object;
+    const std::string* key;   // the member followed, for objects
+};
+
+// Checks the remaining members or elements of level, with c.p just after
+// the last one read, and moves past its closing bracket. The full parser
+// keeps the last of repeated members, so a second member with the key
+// that was followed (or an escaped key, which might be one) is left to it.
+bool closeLevel(Cursor& c, const Level& level, int depth) {
+    char close = level.object ? '}' : ']';
+    while (true) {
+        skipSpace(c);
+        if (c.p >= c.end) {
+            return false;
+        }
+        if (*c.p == close) {
+            c.p++;
+            return true;
+        }
+        if (*c.p != ',') {
+            return false;
+        }
+        c.p++;
+        skipSpace(c);
+        if (level.object) {
+            if (c.p >= c.end || *c.p != '"') {
+                return false;
+            }
+            const char* keyBegin = c.p + 1;
+            if (!skipString(c)) {
+                return false;
+            }
+            const char* keyEnd = c.p - 1;
+            if (std::memchr(keyBegin, '\\', keyEnd - keyBegin) ||
+                level.key->compare(0, std::string::npos, keyBegin, keyEnd - keyBegin) == 0) {
+                return false;
+            }
+            skipSpace(c);
+            if (c.p >= c.end || *c.p != ':') {
+                return false;
+            }
+            c.p++;
+            skipSpace(c);
+        }
+        if (!skipValue(c, depth)) {
+            return false;
+        }
+    }
+}
+
+std::vector<std::string> splitPointer(const std::string& pointer) {
+    std::vector<std::string> segments;
+    size_t at = 0;
+    while (at < pointer.size() && pointer[at] == '/') {
+        size_t next = pointer.find('/', at + 1);
+        std::string raw = pointer.substr(at + 1, next == std::string::npos ? next : next - at - 1);
+
+        std::string segment;
+        for (size_t i = 0; i < raw.size(); i++) {
+            if (raw[i] == '~' && i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1')) {
+                segment += raw[++i] == '0' ? '~' : '/';
+            } else {
+                segment += raw[i];
+            }
+        }
+        segments.push_back(segment);
+        at = next;
+    }
+    return segments;
+}
+
+// Finds the value at the path; on Found, [begin, end) is its raw text.
+// The whole document is checked either way, so Found and Missing are only
+// given for well-formed text.
+Scan scan(const std::string& text, const std::vector<std::string>& path,
+          const char*& begin, const char*& end) {
+    Cursor c{text.data(), text.data() + text.size()};
+    std::vector<Level> open;
+    Scan result = Scan::Found;
+
+    for (const std::string& segment : path) {
+        skipSpace(c);
+        if (c.p >= c.end) {
+            return Scan::Unsupported;
+        }
+
+        if (*c.p == '{') {
+            c.p++;
+            open.push_back(Level{true, &segment});
+            skipSpace(c);
+            if (c.p < c.end && *c.p == '}') {
+                c.p++;
+                open.pop_back();
+                result = Scan::Missing;
+                break;
+            }
+            bool found = false;
+            while (true) {
+                if (c.p >= c.end || *c.p != '"') {
+                    return Scan::Unsupported;
+                }
+                const char* keyBegin = c.p + 1;
+                if (!skipString(c)) {
+                    return Scan::Unsupported;
+                }
+                const char* keyEnd = c.p - 1;
+                if (std::memchr(keyBegin, '\\', keyEnd - keyBegin)) {
+                    return Scan::Unsupported;
+                }
+
+                skipSpace(c);
+                if (c.p >= c.end || *c.p != ':') {
+                    return Scan::Unsupported;
+                }
+                c.p++;
+                skipSpace(c);
+
+                if (segment.compare(0, std::string::npos, keyBegin, keyEnd - keyBegin) == 0) {
+                    found = true;
+                    break;
+                }
+                if (!skipValue(c, static_cast<int>(open.size()))) {
+                    return Scan::Unsupported;
+                }
+                skipSpace(c);
+                if (c.p < c.end && *c.p == ',') {
+                    c.p++;
+                    skipSpace(c);
+                } else if (c.p < c.end && *c.p == '}') {
+                    c.p++;
+                    break;
+                } else {
+                    return Scan::Unsupported;
+                }
+            }
+            if (!found) {
+                open.pop_back();
+                result = Scan::Missing;
+                break;
+            }
+        } else if (*c.p == '[') {
+            bool numeric = !segment.empty() && segment.size() <= 9 &&
+                           segment.find_first_not_of("0123456789") == std::string::npos;
+            unsigned long index = numeric ? std::stoul(segment) : 0;
+            c.p++;
+            open.push_back(Level{false, nullptr});
+            skipSpace(c);
+            if (c.p < c.end && *c.p == ']') {
+                c.p++;
+                open.pop_back();
+                result = Scan::Missing;
+                break;
+            }
+            bool found = false;
+            for (unsigned long i = 0;; i++) {
+                if (numeric && i == index) {
+                    found = true;
+                    break;
+                }
+                if (!skipValue(c, static_cast<int>(open.size()))) {
+                    return Scan::Unsupported;
+                }
+                skipSpace(c);
+                if (c.p < c.end && *c.p == ',') {
+                    c.p++;
+                    skipSpace(c);
+                } else if (c.p < c.end && *c.p == ']') {
+                    c.p++;
+                    break;
+                } else {
+                    return Scan::Unsupported;
+                }
+            }
+            if (!found) {
+                open.pop_back();
+                result = Scan::Missing;
+                break;
+            }
+        } else {
+            // A scalar has no members
+            if (!skipValue(c, static_cast<int>(open.size()))) {
+                return Scan::Unsupported;
+            }
+            result = Scan::Missing;
+            break;
+        }
+    }
+
+    if (result == Scan::Found) {
+        skipSpace(c);
+        begin = c.p;
+        if (!skipValue(c, static_cast<int>(open.size()))) {
+            return Scan::Unsupported;
+        }
+        end = c.p;
+    }
+
+    // The rest of every enclosing container, then nothing but whitespace
+    while (!open.empty()) {
+        if (!closeLevel(c, open.back(), static_cast<int>(open.size()))) {
+            return Scan::Unsupported;
+        }
+        open.pop_back();
+    }
+    skipSpace(c);
+    if (c.p != c.end) {
+        return Scan::Unsupported;
+    }
+    return result;
+}
+
+bool parse(const char* begin, const char* end, Json::Value& root) {
+    static Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errs;
+    return reader->parse(begin, end, &root, &errs);
+}
+
+// Fallback: full parse, then follow the path through the DOM
+bool lookup(const std::string& text, const std::vector<std::string>& path, Json::Value& result) {
+    Json::Value root;
+    if (!parse(text.data(), text.data() + text.size(), root)) {
+        return false;
+    }
+
+    const Json::Value* node = &root;
+    for (const std::string& segment : path) {
+        if (node->isObject() && node->isMember(segment)) {
+            node = &(*node)[segment];
+        } else if (node->isArray() && !segment.empty() &&
+                   segment.find_first_not_of("0123456789") == std::string::npos &&
+                   std::stoul(segment) < node->size()) {
+            node = &(*node)[static_cast<Json::ArrayIndex>(std::stoul(segment))];
+        } else {
+            return false;
+        }
+    }
+    result = *node;
+    return true;
+}
+
+}
+
+bool jsonHasMember(const std::string& text, const std::string& pointer) {
+    std::vector<std::string> path = splitPointer(pointer);
+    const char* begin;
+    const char* end;
+    switch (scan(text, path, begin, end)) {
+        case Scan::Found:
+            return true;
+        case Scan::Missing:
+            return false;
+        case Scan::Unsupported:
+            break;
+    }
+    Json::Value value;
+    return lookup(text, path, value);
+}
+
+bool jsonString(const std::string& text, const std::string& pointer, std::string& value) {
+    std::vector<std::string> path = splitPointer(pointer);
+    const char* begin;
+    const char* end;
+    switch (scan(text, path, begin, end)) {
+        case Scan::Found:
+            if (*begin != '"') {
+                return false;
+            }
+            // Plain strings are copied as they are; escapes need decoding,
+            // but only of this one value
+            if (!std::memchr(begin, '\\', end - begin)) {
+                value.assign(begin + 1, end - 1);
+                return true;
+            } else {
+                Json::Value node;
+                if (!parse(begin, end, node) || !node.isString()) {
+                    return false;
+                }
+                value = node.asString();
+                return true;
+            }
+        case Scan::Missing:
+            return false;
+        case Scan::Unsupported:
+            break;
+    }
+
+    Json::Value node;
+    if (!lookup(text, path, node) || !node.isString()) {
+        return false;
+    }
+    value = node.asString();
+    return true;
+}
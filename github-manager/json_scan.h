@@ -0,0 +1,27 @@
+#ifndef GITHUB_MANAGER_JSON_SCAN_H
+#define GITHUB_MANAGER_JSON_SCAN_H
+
+#include <string>
+
+// On-demand field lookup in JSON text.
+//
+// Most responses are inspected for one or two fields ("content", "id",
+// "sha"), while the documents themselves can be large (a contents GET
+// carries the whole file, a contents PUT echoes commit and tree objects).
+// These helpers walk the text once, skipping everything that is not on the
+// path to the requested field, without building a DOM. The skipped parts
+// are still checked (brackets balance, strings end, scalars are well
+// formed), so malformed or truncated text is never half answered. Text the
+// scanner does not handle (escaped keys, repeated keys on the path,
+// malformed input) falls back to a full parse, which decides.
+//
+// Fields are addressed with JSON pointers (RFC 6901): "/content",
+// "/commit/sha", "/tree/0/path".
+
+// True if the document has a value at pointer (null counts).
+bool jsonHasMember(const std::string& text, const std::string& pointer);
+
+// Reads the string at pointer; false if it is missing or not a string.
+bool jsonString(const std::string& text, const std::string& pointer, std::string& value);
+
+#endif
@@ -1,181 +1,956 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
 #include <curl/curl.h>
-#include <openssl/evp.h>
 #include <json/json.h>
+#include "base64.h"
+#include "content_scan.h"
+#include "contents_payload.h"
+#include "curl_pool.h"
+#include "curl_share.h"
+#include "dir_walker.h"
+#include "file_batch.h"
+#include "file_source.h"
+#include "git_blob.h"
+#include "http_transport.h"
+#include "json_dom.h"
+#include "json_scan.h"
+#include "rate_limiter.h"
+#include "request_body.h"
+#include "response_cache.h"
+#include "retry_policy.h"
+#include "routes.h"
+#include "upload_engine.h"
 
 namespace fs = std::filesystem;
 
-// Base64 encoding function
-std::string base64_encode(const std::string& input) {
-    BIO *bio, *b64;
-    BUF_MEM *bufferPtr;
-
-    b64 = BIO_new(BIO_f_base64());
-    bio = BIO_new(BIO_s_mem());
-    bio = BIO_push(b64, bio);
-
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
-    BIO_write(bio, input.c_str(), input.length());
-    BIO_flush(bio);
-    BIO_get_mem_ptr(bio, &bufferPtr);
-
-    std::string result(bufferPtr->data, bufferPtr->length);
-    BIO_free_all(bio);
-
-    return result;
+// Parses a response body in place, without copying it into a stream first
+bool parseJson(const std::string& text, Json::Value& result) {
+    static const Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+    std::string errs;
+    return reader->parse(text.data(), text.data() + text.size(), &result, &errs);
 }
 
-// Callback function for cURL responses
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* output) {
-    size_t totalSize = size * nmemb;
-    output->append((char*)contents, totalSize);
-    return totalSize;
-}
+// Runtime settings taken from the command line
+struct ClientOptions {
+    int maxInFlight = 8;     // concurrent uploads in uploadDirectory
+    std::string apiURL = "https://api.github.com";
+    std::string cacheDirectory = ResponseCache::defaultDirectory();   // "" disables
+    int maxAttempts = 4;     // tries per request on transient failures
+    long retryBudget = 200;  // retries shared by all requests of a run
+    bool verbose = false;    // report parser statistics
+    bool ioUring = true;     // batch file reads through io_uring when available
+    std::vector<std::string> excludes;   // gitignore-style patterns for directory uploads
+    bool gitignore = true;   // honour .gitignore and .git/info/exclude
+    bool singleCommit = false;   // directory uploads as one commit (Git Data API)
+    TransportOptions transport;
+};
 
 class GitHubAPI {
 private:
+    ClientOptions options;
     std::string token;
     std::string username;
-    std::string baseURL = "https://api.github.com";
-    
-    std::string makeRequest(const std::string& url, const std::string& method, 
-                           const std::string& data = "") {
-        CURL* curl = curl_easy_init();
-std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string content = buffer.str();
-        file.close();
+    std::string baseURL;
+    
+    std::unique_ptr<CurlShare> share;
+    CurlHandlePool handlePool;
+    RateLimiter rateLimiter;
+    RetryPolicy retryPolicy;
+    ResponseCache responseCache;
+    std::map<std::string, std::pair<std::string, Json::Value>> parsedResponses;
+    struct curl_slist* headers = nullptr;
+    
+    static const int kMaxRateLimitReplays = 5;
+    static const std::uintmax_t kStreamingThreshold = 1024 * 1024;
+    static const size_t kScanBatch = 64;
+    static const std::uintmax_t kFileSizeLimit = 100 * 1024 * 1024;
+    static const std::uintmax_t kLargeFileWarning = 50 * 1024 * 1024;
+    static const int kMaxRebases = 5;
+    
+    // Performs a request, waiting for the rate limiter first, replaying it
+    // if GitHub rejected it because of a rate limit and retrying transient
+    // failures where the retry policy allows it
+    HttpResponse makeRequest(const std::string& url, const std::string& method, 
+                             const std::string& data = "", ResponseSink* sink = nullptr) {
+        return performRequest(url, method, &data, nullptr, sink);
+    }
+    
+    // Same, with the body streamed from bodySource while sending
+    HttpResponse makeRequest(const std::string& url, const std::string& method,
+                             RequestBody& bodySource, ResponseSink* sink = nullptr) {
+        return performRequest(url, method, nullptr, &bodySource, sink);
+    }
+    
+    HttpResponse performRequest(const std::string& url, const std::string& method,
+                                const std::string* data, RequestBody* bodySource,
+                                ResponseSink* sink) {
+        CurlHandlePool::Lease lease = handlePool.acquire();
+        CURL* curl = lease.get();
+        HttpResponse response;
         
-        // Base64 encode the content
-        std::string encodedContent = base64_encode(content);
+        // Revalidate cached GETs instead of downloading them again
+        ResponseCache::Entry cached;
+        bool cacheable = method == "GET" && !sink;
+        bool haveCached = cacheable && responseCache.load(url, cached);
+        // The validators are linked in front of the shared header list
+        // rather than copying it, and unlinked again before being freed
+        struct curl_slist* validators = nullptr;
+        if (haveCached) {
+            if (!cached.etag.empty()) {
+                validators = curl_slist_append(validators, 
+                                               ("If-None-Match: " + cached.etag).c_str());
+            }
+            if (!cached.lastModified.empty()) {
+                validators = curl_slist_append(validators, 
+                                               ("If-Modified-Since: " + cached.lastModified).c_str());
+            }
+        }
+        struct curl_slist* validatorsTail = validators;
+        while (validatorsTail && validatorsTail->next) {
+            validatorsTail = validatorsTail->next;
+        }
+        struct curl_slist* requestHeaders = headers;
+        if (validatorsTail) {
+            validatorsTail->next = headers;
+            requestHeaders = validators;
+        }
         
-        // Get filename from path
-        fs::path p(filePath);
-        std::string fileName = p.filename().string();
+        int failures = 0;
+        int replays = 0;
+        for (int attempt = 0; curl; attempt++) {
+            if (attempt > 0) {
+                handlePool.reset(curl);
+                response = HttpResponse();
+            }
+            response.sink = sink;
+            rateLimiter.acquire(method);
+            
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, requestHeaders);
+            applyTransportOptions(curl, options.transport, url);
+            captureResponse(curl, response);
+            
+            if (bodySource) {
+                if (!bodySource->rewind()) {
+                    response.result = CURLE_READ_ERROR;
+                    break;
+                }
+                attachRequestBody(curl, *bodySource);
+                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+            } else if (method == "POST") {
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data->c_str());
+            } else if (method == "PUT" || method == "PATCH") {
+                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data->c_str());
+            } else if (method == "DELETE") {
+                // The contents API takes the sha being deleted in the body
+                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+                if (!data->empty()) {
+                    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data->c_str());
+                }
+            }
+            
+            CURLcode res = curl_easy_perform(curl);
+            completeResponse(curl, res, response);
+            
+            // A sink that already received part of the body cannot be
+            // rewound; error bodies go to response.body and do not count
+            std::chrono::milliseconds delay(0);
+            bool sinkUntouched = !sink || response.sinkBytes == 0;
+            // Only looked up after a failure, since it may scan the body
+            bool conditional = RetryPolicy::isTransient(response) &&
+                               (bodySource ? bodySource->conditional()
+                                           : method == "PUT" && jsonHasMember(*data, "/sha"));
+            if (sinkUntouched && 
+                retryPolicy.shouldRetry(method, url, conditional, response, failures + 1, delay)) {
+                failures++;
+                std::cerr << "Transient failure (" 
+                          << (res != CURLE_OK ? curl_easy_strerror(res) 
+                                              : "HTTP " + std::to_string(response.status))
+                          << "), retrying in " << delay.count() << "ms" << std::endl;
+                std::this_thread::sleep_for(delay);
+                continue;
+            }
+            
+            if (res != CURLE_OK) {
+                std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
+                break;
+            }
+            handlePool.recordTransfer(curl, response);
+            
+            if (!rateLimiter.update(method, response) || ++replays > kMaxRateLimitReplays) {
+                break;
+            }
+        }
         
-        // Create JSON payload
-        Json::Value root;
-        root["message"] = commitMessage;
-        root["content"] = encodedContent;
+        if (validatorsTail) {
+            validatorsTail->next = nullptr;
+            curl_slist_free_all(validators);
+        }
         
-        Json::StreamWriterBuilder writer;
-        std::string jsonData = Json::writeString(writer, root);
+        if (haveCached && response.result == CURLE_OK && response.status == 304) {
+            responseCache.recordRevalidation();
+            response.status = 200;
+            response.body = std::move(cached.body);
+            response.fromCache = true;
+        } else if (cacheable && response.succeeded()) {
+            responseCache.store(url, response);
+        }
         
-        // Make API request
-        std::string url = baseURL + "/repos/" + username + "/" + repoName + 
-                         "/contents/" + fileName;
-        std::string response = makeRequest(url, "PUT", jsonData);
+        return response;
+    }
+    
+    // GETs a JSON document. A 304 for a document already parsed in this
+    // session reuses the parsed value instead of parsing the body again.
+    bool fetchJson(const std::string& url, Json::Value& result) {
+        HttpResponse response = makeRequest(url, "GET");
+        if (!response.succeeded()) {
+            return false;
+        }
         
-        Json::Value responseJson;
-        Json::CharReaderBuilder readerBuilder;
-        std::istringstream responseStream(response);
-        std::string errs;
+        std::string etag = response.header("etag");
+        auto parsed = parsedResponses.find(url);
+        if (response.fromCache && parsed != parsedResponses.end() && 
+            !etag.empty() && parsed->second.first == etag) {
+            result = parsed->second.second;
+            return true;
+        }
+        
+        if (!parseJson(response.body, result)) {
+            return false;
+        }
+        
+        if (!etag.empty()) {
+            parsedResponses[url] = std::make_pair(etag, result);
+        }
+        return true;
+    }
+    
+    std::string contentsURL(const std::string& repoName, const std::string& remotePath) const {
+        return routes::kContents.build(baseURL, {username, repoName, remotePath});
+    }
+    
+    // Wraps a local file into a contents API PUT body. The base64 text is
+    // encoded from the file source's spans straight into jsonData between
+    // the payload's head and tail, so the file is never held raw or copied
+    // again.
+    bool buildUploadPayload(const std::string& localPath, const ContentsPayload& payload,
+                            std::string& jsonData) {
+        FileSource source(localPath);
+        if (!source.isOpen()) {
+            std::cerr << "Cannot open file: " << localPath << std::endl;
+            return false;
+        }
         
-        if (Json::parseFromStream(readerBuilder, responseStream, &responseJson, &errs)) {
-            if (responseJson.isMember("content")) {
-                std::cout << "File uploaded successfully: " << fileName << std::endl;
+        std::string tail = payload.tail();
+        jsonData = payload.head();
+        size_t at = jsonData.size();
+        jsonData.resize(at + base64EncodedSize(source.size()));
+        
+        Base64Encoder encoder;
+        const char* data;
+        size_t length;
+        while (source.next(data, length)) {
+            at += encoder.update(data, length, &jsonData[at]);
+        }
+        if (source.failed()) {
+            std::cerr << "Cannot read file: " << localPath << std::endl;
+            return false;
+        }
+        at += encoder.finish(&jsonData[at]);
+        jsonData.resize(at);
+        jsonData += tail;
+        return true;
+    }
+    
+    // Contents API PUT body for content already in memory
+    static void wrapContent(std::string_view content, const ContentsPayload& payload,
+                            std::string& jsonData) {
+        std::string tail = payload.tail();
+        jsonData = payload.head();
+        size_t at = jsonData.size();
+        jsonData.resize(at + base64EncodedSize(content.size()) + tail.size());
+        base64Encode(content.data(), content.size(), &jsonData[at]);
+        at += base64EncodedSize(content.size());
+        jsonData.replace(at, tail.size(), tail);
+    }
+    
+    // Decides whether a file can go through the contents API and reports
+    // what it holds. Files over GitHub's hard limit are left for Git LFS;
+    // large files and mixed line endings only warn. Returns false if the
+    // file must not be uploaded.
+    bool checkUploadPolicy(const std::string& localPath, const std::string& label,
+                           std::string& type) {
+        if (!withinSizeLimit(localPath, label)) {
+            return false;
+        }
+        
+        ContentProfile profile;
+        if (!scanFile(localPath, profile)) {
+            type.clear();
+            return true;
+        }
+        reportContent(localPath, label, profile, type);
+        return true;
+    }
+    
+    // Same, for a small file already loaded into memory
+    void checkUploadPolicy(const std::string& localPath, const std::string& label,
+                           std::string_view content, std::string& type) {
+        ContentScanner scanner;
+        scanner.update(content.data(), content.size());
+        reportContent(localPath, label, scanner.finish(), type);
+    }
+    
+    // GitHub refuses files over 100 MB, so they are skipped before anything
+    // reads their content
+    bool withinSizeLimit(const std::string& label, std::uintmax_t size) {
+        if (size > kFileSizeLimit) {
+            std::cerr << "Skipping " << label << ": " << size / (1024 * 1024) 
+                      << " MB is over GitHub's 100 MB limit; track it with Git LFS" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    bool withinSizeLimit(const std::string& localPath, const std::string& label) {
+        std::error_code ec;
+        std::uintmax_t size = fs::file_size(localPath, ec);
+        return ec || withinSizeLimit(label, size);
+    }
+    
+    void reportContent(const std::string& localPath, const std::string& label,
+                       const ContentProfile& profile, std::string& type) {
+        type = contentType(localPath, profile);
+        if (profile.size > kLargeFileWarning) {
+            std::cerr << "Warning: " << label << " is " << profile.size / (1024 * 1024) 
+                      << " MB" << (profile.binary() ? " of binary data" : "") 
+                      << "; GitHub recommends Git LFS above 50 MB" << std::endl;
+        }
+        if (!profile.binary() && profile.mixedLineEndings()) {
+            std::cerr << "Warning: " << label << " mixes CRLF (" << profile.crlfLines 
+                      << ") and LF (" << profile.lfLines << ") line endings" << std::endl;
+        }
+    }
+    
+    // Large files are streamed from disk while sending; small ones are
+    // cheaper to send from one in-memory buffer
+    bool prepareUpload(const std::string& localPath, const ContentsPayload& payload,
+                       std::string& jsonData, std::unique_ptr<RequestBody>& bodySource) {
+        std::error_code ec;
+        std::uintmax_t size = fs::file_size(localPath, ec);
+        if (ec || size < kStreamingThreshold) {
+            return buildUploadPayload(localPath, payload, jsonData);
+        }
+        
+        auto body = std::make_unique<ContentsUploadBody>(localPath, payload);
+        if (!body->isOpen()) {
+            std::cerr << "Cannot open file: " << localPath << std::endl;
+            return false;
+        }
+        bodySource = std::move(body);
+        return true;
+    }
+    
+    HttpResponse putContents(const std::string& url, const std::string& jsonData,
+                             RequestBody* bodySource) {
+        return bodySource ? makeRequest(url, "PUT", *bodySource)
+                          : makeRequest(url, "PUT", jsonData);
+    }
+    
+    // Blob ids of all files in a tree (by default the default branch's),
+    // keyed by path. Stays empty for an empty repository (the API answers
+    // 409) or on errors, in which case every file is uploaded as new.
+    void fetchRemoteBlobs(const std::string& repoName,
+                          std::map<std::string, std::string>& blobs,
+                          const std::string& treeish = "HEAD") {
+        Json::Value tree;
+        if (!fetchJson(routes::kTree.build(baseURL, {username, repoName, treeish}), tree)) {
+            return;
+        }
+        if (tree["truncated"].asBool()) {
+            std::cerr << "Warning: remote tree is too large to list completely; "
+                      << "files outside the listing are uploaded as new" << std::endl;
+        }
+        for (const auto& entry : tree["tree"]) {
+            if (entry["type"].asString() == "blob") {
+                blobs[entry["path"].asString()] = entry["sha"].asString();
+            }
+        }
+    }
+    
+    // Looks up the blob currently stored at remotePath and records it in
+    // payload.sha, which the API requires for replacing a file. Reads the
+    // parent directory listing, not the file, which would carry its whole
+    // content. Returns true if that blob is localId, the local file's.
+    bool matchesRemote(const std::string& repoName, const std::string& localId,
+                       const std::string& remotePath, ContentsPayload& payload) {
+        size_t slash = remotePath.rfind('/');
+        std::string parent = slash == std::string::npos ? "" : remotePath.substr(0, slash);
+        
+        Json::Value listing;
+        if (!fetchJson(contentsURL(repoName, parent), listing) || !listing.isArray()) {
+            return false;
+        }
+        for (const auto& entry : listing) {
+            if (entry["path"].asString() == remotePath && entry["type"].asString() == "file") {
+                payload.sha = entry["sha"].asString();
+                return !localId.empty() && localId == payload.sha;
+            }
+        }
+        return false;
+    }
+    
+    // A successful contents API PUT echoes the stored file under "content"
+    static bool isContentResponse(const std::string& response) {
+        return jsonHasMember(response, "/content");
+    }
+    
+    // Tip of a branch, which a single-commit upload builds on
+    struct BranchHead {
+        std::string branch;   // looked up as the default branch if empty
+        std::string commit;
+        std::string tree;
+    };
+    
+    struct TreeEntry {
+        std::string path;
+        std::string mode;
+        std::string sha;
+    };
+    
+    bool fetchBranchHead(const std::string& repoName, BranchHead& head) {
+        if (head.branch.empty()) {
+            Json::Value repository;
+            if (!fetchJson(routes::kRepository.build(baseURL, {username, repoName}), repository)) {
+                return false;
+            }
+            head.branch = repository["default_branch"].asString();
+        }
+        
+        // An empty repository has no branch yet (404)
+        Json::Value branch;
+        if (head.branch.empty() || 
+            !fetchJson(routes::kBranch.build(baseURL, {username, repoName, head.branch}), branch)) {
+            return false;
+        }
+        head.commit = branch["commit"]["sha"].asString();
+        head.tree = branch["commit"]["commit"]["tree"]["sha"].asString();
+        return !head.commit.empty() && !head.tree.empty();
+    }
+    
+    static std::string fileMode(const std::string& localPath) {
+        std::error_code ec;
+        fs::perms permissions = fs::status(localPath, ec).permissions();
+        bool executable = !ec && (permissions & fs::perms::owner_exec) != fs::perms::none;
+        return executable ? "100755" : "100644";
+    }
+    
+    // Commits entries (blobs already uploaded) on top of head in one go:
+    // a tree based on the head's tree, a commit, and a fast-forward of the
+    // branch. If someone pushed in the meantime the ref update is refused;
+    // the same entries are then applied to the new head and tried again.
+    bool commitEntries(const std::string& repoName, const std::string& message,
+                       const std::vector<TreeEntry>& entries, BranchHead& head) {
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        Json::Value tree(Json::arrayValue);
+        for (const TreeEntry& entry : entries) {
+            Json::Value item;
+            item["path"] = entry.path;
+            item["mode"] = entry.mode;
+            item["type"] = "blob";
+            item["sha"] = entry.sha;
+            tree.append(item);
+        }
+        
+        for (int attempt = 0; attempt < kMaxRebases; attempt++) {
+            if (attempt > 0) {
+                if (!fetchBranchHead(repoName, head)) {
+                    std::cerr << "Cannot read branch " << head.branch << std::endl;
+                    return false;
+                }
+                std::cout << "Branch " << head.branch << " moved; rebasing onto " 
+                          << head.commit.substr(0, 7) << "..." << std::endl;
+            }
+            
+            Json::Value treeRequest;
+            treeRequest["base_tree"] = head.tree;
+            treeRequest["tree"] = tree;
+            HttpResponse response = makeRequest(routes::kTrees.build(baseURL, {username, repoName}), 
+                                                "POST", Json::writeString(writer, treeRequest));
+            std::string treeSha;
+            if (!response.succeeded() || !jsonString(response.body, "/sha", treeSha)) {
+                std::cerr << "Failed to create tree (HTTP " << response.status << "): " 
+                          << response.body << std::endl;
+                return false;
+            }
+            if (treeSha == head.tree) {
+                std::cout << "Nothing to commit: " << head.branch 
+                          << " already has this content" << std::endl;
+                return true;
+            }
+            
+            Json::Value commitRequest;
+            commitRequest["message"] = message;
+            commitRequest["tree"] = treeSha;
+            commitRequest["parents"].append(head.commit);
+            response = makeRequest(routes::kCommits.build(baseURL, {username, repoName}), 
+                                   "POST", Json::writeString(writer, commitRequest));
+            std::string commitSha;
+            if (!response.succeeded() || !jsonString(response.body, "/sha", commitSha)) {
+                std::cerr << "Failed to create commit (HTTP " << response.status << "): " 
+                          << response.body << std::endl;
+                return false;
+            }
+            
+            Json::Value refRequest;
+            refRequest["sha"] = commitSha;
+            refRequest["force"] = false;
+            response = makeRequest(routes::kBranchRef.build(baseURL, {username, repoName, head.branch}),
+                                   "PATCH", Json::writeString(writer, refRequest));
+            if (response.succeeded()) {
+                std::cout << "Committed " << entries.size() << " files to " << head.branch 
+                          << " as " << commitSha.substr(0, 7) << std::endl;
                 return true;
             }
+            // 422: not a fast-forward any more
+            if (response.status != 422) {
+                std::cerr << "Failed to update " << head.branch << " (HTTP " << response.status 
+                          << "): " << response.body << std::endl;
+                return false;
+            }
         }
+        std::cerr << "Giving up: " << head.branch << " kept moving while committing" << std::endl;
+        return false;
+    }
+
+public:
+    GitHubAPI(const std::string& _token, const std::string& _username,
+              const ClientOptions& _options = ClientOptions()) 
+        : options(_options), token(_token), username(_username), baseURL(_options.apiURL),
+          retryPolicy(_options.maxAttempts, _options.retryBudget),
+          responseCache(_options.cacheDirectory, _token) {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        share = std::make_unique<CurlShare>(std::max(options.maxInFlight, 5));
+        handlePool.setShare(share.get());
         
-        std::cerr << "Failed to upload file: " << response << std::endl;
+        // Header list is identical for every request, so build it once
+        headers = curl_slist_append(headers, ("Authorization: token " + token).c_str());
+        headers = curl_slist_append(headers, "User-Agent: CPP-GitHub-Client");
+        headers = curl_slist_append(headers, "Accept: application/vnd.github.v3+json");
+        headers = curl_slist_append(headers, "Content-Type: application/json");
+        // Streamed uploads would otherwise wait for a 100 Continue first
+        headers = curl_slist_append(headers, "Expect:");
+    }
+    
+    ~GitHubAPI() {
+        handlePool.clear();
+        share.reset();
+        curl_slist_free_all(headers);
+        curl_global_cleanup();
+    }
+    
+    void printConnectionStats() const {
+        std::cout << "Connection reuse: "
+                  << static_cast<int>(handlePool.reuseRatio() * 100) << "% ("
+                  << handlePool.newConnectionCount() << " handshakes for "
+                  << handlePool.requestCount() << " requests)" << std::endl;
+        std::cout << "Shared cache: " << share->dnsHits() << " DNS hits, "
+                  << share->dnsLookups() << " DNS lookups, "
+                  << share->tlsResumed() << " TLS resumptions, "
+                  << share->tlsFullHandshakes() << " full TLS handshakes" << std::endl;
+        std::cout << "Downloaded: " << handlePool.wireByteCount() << " bytes on the wire, "
+                  << handlePool.decodedByteCount() << " bytes decoded";
+        if (options.transport.compression) {
+            std::cout << " (accepting " << supportedEncodings() << ")";
+        }
+        std::cout << std::endl;
+    }
+    
+    bool createRepository(const std::string& repoName, const std::string& description, 
+                         bool isPrivate = false) {
+        Json::Value root;
+        root["name"] = repoName;
+        root["description"] = description;
+        root["private"] = isPrivate;
+        root["auto_init"] = true;
+        
+        Json::StreamWriterBuilder writer;
+        std::string jsonData = Json::writeString(writer, root);
+        
+        std::string url = routes::kUserRepos.build(baseURL, {});
+        HttpResponse response = makeRequest(url, "POST", jsonData);
+        
+        std::string htmlURL;
+        if (jsonHasMember(response.body, "/id")) {
+            jsonString(response.body, "/html_url", htmlURL);
+            std::cout << "Repository created successfully!" << std::endl;
+            std::cout << "URL: " << htmlURL << std::endl;
+            return true;
+        }
+        
+        std::cerr << "Failed to create repository: " << response.body << std::endl;
         return false;
     }
     
+    bool uploadFile(const std::string& repoName, const std::string& filePath, 
+                   const std::string& commitMessage) {
+        // Stored at the repository root under its own name
+        std::string fileName = fs::path(filePath).filename().string();
+        return uploadFileWithPath(repoName, filePath, fileName, commitMessage);
+    }
+    
     bool uploadDirectory(const std::string& repoName, const std::string& dirPath,
                         const std::string& commitMessage) {
         int successCount = 0;
         int failCount = 0;
+        int unchangedCount = 0;
+        int tooLargeCount = 0;
+        int reusedCount = 0;
         
-        for (const auto& entry : fs::recursive_directory_iterator(dirPath)) {
-            if (entry.is_regular_file()) {
-                std::string relativePath = fs::relative(entry.path(), dirPath).string();
-                std::cout << "Uploading: " << relativePath << "..." << std::endl;
-                
-                if (uploadFileWithPath(repoName, entry.path().string(), 
-                                      relativePath, commitMessage)) {
-                    successCount++;
+        // In single-commit mode changed files are posted as blobs and
+        // committed together at the end, on top of the branch head that
+        // the local files are compared with
+        BranchHead head;
+        std::vector<TreeEntry> entries;
+        bool asCommit = options.singleCommit;
+        if (asCommit && !fetchBranchHead(repoName, head)) {
+            std::cerr << "Cannot find the default branch (a new repository has none yet); "
+                      << "uploading file by file" << std::endl;
+            asCommit = false;
+        }
+        ContentsPayload payload = asCommit ? ContentsPayload::blob() : ContentsPayload(commitMessage);
+        
+        // Files whose blob id matches the remote tree are skipped; changed
+        // ones are sent with the sha of the blob they replace
+        std::map<std::string, std::string> remoteBlobs;
+        fetchRemoteBlobs(repoName, remoteBlobs, asCommit ? head.tree : "HEAD");
+        // Content already stored under another path needs no new blob
+        std::unordered_set<std::string> remoteIds;
+        if (asCommit) {
+            for (const auto& blob : remoteBlobs) {
+                remoteIds.insert(blob.second);
+            }
+        }
+        
+        std::string root = dirPath.empty() || dirPath.back() == '/' ? dirPath : dirPath + "/";
+        
+        // Ignored files are dropped during the walk, before they cost a
+        // read or an API call. dirPath is treated as the top of the tree:
+        // .gitignore files above it, and the info/exclude of a repository
+        // it sits inside, are not read, since their patterns are relative
+        // to a root the upload does not share
+        IgnoreRules commandLine;
+        for (const std::string& pattern : options.excludes) {
+            commandLine.add(pattern);
+        }
+        IgnoreRules infoExclude;
+        std::string excludeFile;
+        if (options.gitignore && readFile(root + ".git/info/exclude", excludeFile)) {
+            infoExclude.parse(excludeFile);
+        }
+        
+        FileList files;
+        DirectoryWalker walker;
+        walker.setExcludes(std::move(commandLine), std::move(infoExclude), options.gitignore);
+        if (!walker.walk(dirPath, files)) {
+            return false;
+        }
+        if (options.verbose) {
+            std::cout << "Found " << files.size() << " files in " << walker.directoriesRead() 
+                      << " directories" << std::endl;
+        }
+        size_t nextFile = 0;
+        
+        // Files are scanned a batch at a time. Small files are loaded
+        // together by the batch reader (through io_uring where the kernel
+        // allows) and then hashed, classified and encoded from memory; the
+        // ones already on the remote are hashed together by the
+        // multi-buffer SHA-1 kernel
+        struct ScannedFile {
+            std::string localPath;
+            std::string relativePath;
+            std::string remoteSha;
+            std::string blobId;   // once hashed
+            ContentProfile profile;   // filled in by the same pass as blobId
+            LoadedFile content;   // valid until the next batch is loaded
+        };
+        std::deque<ScannedFile> scanned;
+        FileBatchReader reader(options.ioUring);
+        
+        auto scanBatch = [&]() {
+            std::vector<std::string> smallPaths;
+            std::vector<size_t> smallSizes;
+            std::vector<size_t> smallFiles;
+            while (nextFile < files.size() && scanned.size() < kScanBatch) {
+                size_t index = nextFile++;
+                ScannedFile file;
+                file.relativePath = std::string(files.path(index));
+                file.localPath = root + file.relativePath;
+                auto remote = remoteBlobs.find(file.relativePath);
+                if (remote != remoteBlobs.end()) {
+                    file.remoteSha = remote->second;
+                }
+                uint64_t size = files.fileSize(index);
+                if (!withinSizeLimit(file.relativePath, size)) {
+                    tooLargeCount++;
+                    continue;
+                }
+                if (size < FileBatchReader::kSlotSize) {
+                    smallPaths.push_back(file.localPath);
+                    smallSizes.push_back(static_cast<size_t>(size));
+                    smallFiles.push_back(scanned.size());
+                }
+                scanned.push_back(file);
+            }
+            
+            std::vector<LoadedFile> loaded;
+            reader.load(smallPaths, smallSizes, loaded);
+            for (size_t i = 0; i < smallFiles.size(); i++) {
+                scanned[smallFiles[i]].content = loaded[i];
+            }
+            
+            std::vector<std::string_view> inMemory;
+            std::vector<std::string> onDisk;
+            // A commit needs every blob id; otherwise only those that can
+            // match a remote file matter
+            for (const ScannedFile& file : scanned) {
+                if (file.remoteSha.empty() && !asCommit) {
+                    continue;
+                }
+                if (file.content.loaded) {
+                    inMemory.emplace_back(file.content.data, file.content.size);
                 } else {
+                    onDisk.push_back(file.localPath);
+                }
+            }
+            if (inMemory.empty() && onDisk.empty()) {
+                return;
+            }
+            
+            std::vector<std::string> memoryIds;
+            std::vector<std::string> diskIds;
+            std::vector<ContentProfile> memoryProfiles;
+            std::vector<ContentProfile> diskProfiles;
+            gitBlobIds(inMemory, memoryIds, &memoryProfiles);
+            gitBlobIds(onDisk, diskIds, &diskProfiles);
+            std::deque<ScannedFile> changed;
+            size_t nextMemory = 0;
+            size_t nextDisk = 0;
+            for (ScannedFile& file : scanned) {
+                if (!file.remoteSha.empty() || asCommit) {
+                    if (file.content.loaded) {
+                        file.profile = memoryProfiles[nextMemory];
+                        file.blobId = memoryIds[nextMemory++];
+                    } else {
+                        file.profile = diskProfiles[nextDisk];
+                        file.blobId = diskIds[nextDisk++];
+                    }
+                    if (file.blobId == file.remoteSha) {
+                        unchangedCount++;
+                        continue;
+                    }
+                }
+                changed.push_back(std::move(file));
+            }
+            scanned.swap(changed);
+        };
+        
+        // Feeds the engine one regular file at a time, so only the
+        // in-flight payloads are ever held in memory
+        auto nextJob = [&](UploadJob& job) {
+            while (!scanned.empty() || nextFile < files.size()) {
+                if (scanned.empty()) {
+                    scanBatch();
+                    continue;
+                }
+                ScannedFile file = std::move(scanned.front());
+                scanned.pop_front();
+                const std::string& localPath = file.localPath;
+                const std::string& relativePath = file.relativePath;
+                if (asCommit && remoteIds.count(file.blobId)) {
+                    entries.push_back(TreeEntry{relativePath, fileMode(localPath), file.blobId});
+                    reusedCount++;
+                    continue;
+                }
+                if (!asCommit) {
+                    payload.sha = file.remoteSha;
+                }
+                
+                std::string type;
+                std::string_view content(file.content.data, file.content.size);
+                if (!file.blobId.empty()) {
+                    reportContent(localPath, relativePath, file.profile, type);
+                } else if (file.content.loaded) {
+                    checkUploadPolicy(localPath, relativePath, content, type);
+                } else if (!checkUploadPolicy(localPath, relativePath, type)) {
+                    tooLargeCount++;
+                    continue;
+                }
+                std::cout << "Uploading: " << relativePath;
+                if (!type.empty()) {
+                    std::cout << " (" << type << ")";
+                }
+                std::cout << "..." << std::endl;
+                if (file.content.loaded) {
+                    wrapContent(content, payload, job.body);
+                } else if (!prepareUpload(localPath, payload, job.body, job.bodySource)) {
                     failCount++;
+                    continue;
                 }
+                job.label = relativePath;
+                job.conditional = !payload.sha.empty();
+                if (asCommit) {
+                    job.url = routes::kBlobs.build(baseURL, {username, repoName});
+                    job.method = "POST";
+                } else {
+                    job.url = contentsURL(repoName, relativePath);
+                    job.method = "PUT";
+                }
+                return true;
+            }
+            return false;
+        };
+        
+        auto onComplete = [&](const UploadJob& job, const HttpResponse& response) {
+            if (response.result != CURLE_OK) {
+                std::cerr << "cURL error (" << job.label << "): " 
+                          << curl_easy_strerror(response.result) << std::endl;
+            }
+            
+            std::string blobSha;
+            if (asCommit && response.succeeded() && jsonString(response.body, "/sha", blobSha)) {
+                entries.push_back(TreeEntry{job.label, fileMode(root + job.label), blobSha});
+                successCount++;
+            } else if (!asCommit && response.succeeded() && isContentResponse(response.body)) {
+                successCount++;
+            } else {
+                std::cerr << "Failed to upload file: " << job.label 
+                          << " (HTTP " << response.status << ")" << std::endl;
+                failCount++;
+            }
+        };
+        
+        MultiUploadEngine engine(handlePool, headers, options.maxInFlight, options.transport,
+                                 &rateLimiter, &retryPolicy);
+        if (!engine.run(nextJob, onComplete)) {
+            failCount++;
+        }
+        
+        if (asCommit) {
+            // A partial commit would look complete; the blobs that did go up
+            // are unreferenced and cost nothing
+            if (failCount > 0) {
+                std::cerr << "Not committing: " << failCount << " files failed to upload" << std::endl;
+            } else if (entries.empty()) {
+                std::cout << "Nothing to commit" << std::endl;
+            } else if (!commitEntries(repoName, commitMessage, entries, head)) {
+                failCount++;
             }
         }
         
         std::cout << "\nUpload complete!" << std::endl;
         std::cout << "Success: " << successCount << " files" << std::endl;
         std::cout << "Failed: " << failCount << " files" << std::endl;
+        if (unchangedCount > 0) {
+            std::cout << "Unchanged: " << unchangedCount << " files (skipped)" << std::endl;
+        }
+        if (reusedCount > 0) {
+            std::cout << "Reused: " << reusedCount << " files already stored in the repository" << std::endl;
+        }
+        if (walker.entriesExcluded() > 0) {
+            std::cout << "Excluded: " << walker.entriesExcluded() 
+                      << " files and directories (ignore rules)" << std::endl;
+        }
+        if (tooLargeCount > 0) {
+            std::cout << "Needs Git LFS: " << tooLargeCount << " files (not uploaded)" << std::endl;
+        }
+        printConnectionStats();
+        if (rateLimiter.throttledCount() > 0) {
+            std::cout << "Rate limited: " << rateLimiter.throttledCount() 
+                      << " requests were delayed and replayed" << std::endl;
+        }
+        if (retryPolicy.retriedCount() > 0) {
+            std::cout << "Retried: " << retryPolicy.retriedCount() 
+                      << " transient failures (" << retryPolicy.budgetLeft() 
+                      << " retries left in budget)" << std::endl;
+        }
         
         return failCount == 0;
     }
     
     bool uploadFileWithPath(const std::string& repoName, const std::string& localPath,
                            const std::string& remotePath, const std::string& commitMessage) {
-        // Read file content
-        std::ifstream file(localPath, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "Cannot open file: " << localPath << std::endl;
+        if (!withinSizeLimit(localPath, remotePath)) {
             return false;
         }
         
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string content = buffer.str();
-        file.close();
+        // One read gives both the blob id, to compare with the remote copy,
+        // and the content profile for the upload policy
+        std::string localId;
+        ContentProfile profile;
+        bool read = gitBlobId(localPath, localId, &profile);
         
-        // Base64 encode
-        std::string encodedContent = base64_encode(content);
+        ContentsPayload payload(commitMessage);
+        if (matchesRemote(repoName, localId, remotePath, payload)) {
+            std::cout << "File unchanged, nothing to upload: " << remotePath << std::endl;
+            return true;
+        }
         
-        // Create JSON payload
-        Json::Value root;
-        root["message"] = commitMessage;
-        root["content"] = encodedContent;
+        std::string type;
+        if (read) {
+            reportContent(localPath, remotePath, profile, type);
+        }
+        if (!type.empty()) {
+            std::cout << "Uploading " << remotePath << " (" << type << ")" << std::endl;
+        }
         
-        Json::StreamWriterBuilder writer;
-        std::string jsonData = Json::writeString(writer, root);
+        std::string jsonData;
+        std::unique_ptr<RequestBody> bodySource;
+        if (!prepareUpload(localPath, payload, jsonData, bodySource)) {
+            return false;
+        }
         
         // Make API request
-        std::string url = baseURL + "/repos/" + username + "/" + repoName + 
-                         "/contents/" + remotePath;
-        std::string response = makeRequest(url, "PUT", jsonData);
-        
-        Json::Value responseJson;
-        Json::CharReaderBuilder readerBuilder;
-        std::istringstream responseStream(response);
-        std::string errs;
+        HttpResponse response = putContents(contentsURL(repoName, remotePath), jsonData,
+                                            bodySource.get());
         
-        if (Json::parseFromStream(readerBuilder, responseStream, &responseJson, &errs)) {
-            if (responseJson.isMember("content")) {
-                return true;
-            }
+        if (response.succeeded() && isContentResponse(response.body)) {
+            std::cout << "File uploaded successfully: " << remotePath << std::endl;
+            return true;
         }
         
+        std::cerr << "Failed to upload file: " << response.body << std::endl;
         return false;
     }
     
     bool deleteFile(const std::string& repoName, const std::string& filePath,
                    const std::string& commitMessage) {
         // First, get the file SHA
-        std::string url = baseURL + "/repos/" + username + "/" + repoName + 
-                         "/contents/" + filePath;
-        std::string response = makeRequest(url, "GET");
-        
-        Json::Value responseJson;
-        Json::CharReaderBuilder readerBuilder;
-        std::istringstream responseStream(response);
-        std::string errs;
-        
-        if (!Json::parseFromStream(readerBuilder, responseStream, &responseJson, &errs)) {
+        std::string url = contentsURL(repoName, filePath);
+        // The response carries the whole file, but only its sha is needed
+        HttpResponse info = makeRequest(url, "GET");
+        std::string sha;
+        if (!info.succeeded() || !jsonString(info.body, "/sha", sha)) {
             std::cerr << "Failed to get file info" << std::endl;
             return false;
         }
         
-        std::string sha = responseJson["sha"].asString();
-        
         // Delete the file
         Json::Value root;
         root["message"] = commitMessage;
@@ -184,45 +959,108 @@ std::stringstream buffer;
         Json::StreamWriterBuilder writer;
         std::string jsonData = Json::writeString(writer, root);
         
-        response = makeRequest(url, "DELETE", jsonData);
+        // The response echoes the commit, which nothing here needs
+        DiscardSink discard;
+        HttpResponse response = makeRequest(url, "DELETE", jsonData, &discard);
+        if (!response.succeeded()) {
+            std::cerr << "Failed to delete file: " << filePath << " ("
+                      << (response.result != CURLE_OK ? curl_easy_strerror(response.result)
+                                                      : "HTTP " + std::to_string(response.status))
+                      << ") " << response.body << std::endl;
+            return false;
+        }
         
         std::cout << "File deleted successfully: " << filePath << std::endl;
         return true;
     }
     
-    void listRepositories() {
-        std::string url = baseURL + "/user/repos";
-        std::string response = makeRequest(url, "GET");
+    // Fetches a file through the contents API and writes it to localPath.
+    // The base64 content is decoded while it arrives, straight into the file.
+    bool downloadFile(const std::string& repoName, const std::string& remotePath,
+                      const std::string& localPath) {
+        // Written beside the destination and renamed over it once complete,
+        // so a failed download leaves any existing file untouched
+        std::string partPath = localPath + ".part";
+        FileSink file(partPath);
+        if (!file.isOpen()) {
+            std::cerr << "Cannot write file: " << partPath << std::endl;
+            return false;
+        }
         
-        Json::Value responseJson;
-        Json::CharReaderBuilder readerBuilder;
-        std::istringstream responseStream(response);
-        std::string errs;
+        ContentsDecodeSink content(file);
+        HttpResponse response = makeRequest(contentsURL(repoName, remotePath), "GET", "", &content);
+        bool decoded = response.succeeded() && content.finish();
+        bool written = file.close();
         
-        if (Json::parseFromStream(readerBuilder, responseStream, &responseJson, &errs)) {
-            std::cout << "\nYour Repositories:" << std::endl;
-            std::cout << "==================" << std::endl;
-            
-            for (const auto& repo : responseJson) {
-                std::cout << "Name: " << repo["name"].asString() << std::endl;
-                std::cout << "Description: " << repo["description"].asString() << std::endl;
-                std::cout << "URL: " << repo["html_url"].asString() << std::endl;
-                std::cout << "Private: " << (repo["private"].asBool() ? "Yes" : "No") << std::endl;
-                std::cout << "------------------" << std::endl;
+        std::string encoding;
+        jsonString(content.metadata(), "/encoding", encoding);
+        std::error_code ec;
+        if (decoded && written && encoding == "base64") {
+            fs::rename(partPath, localPath, ec);
+            if (!ec) {
+                std::cout << "File downloaded successfully: " << localPath << " ("
+                          << content.decodedSize() << " bytes)" << std::endl;
+                return true;
             }
+            written = false;
+        }
+        
+        fs::remove(partPath, ec);
+        if (!response.succeeded()) {
+            std::cerr << "Failed to download file: " << response.body << std::endl;
+        } else if (!encoding.empty() && encoding != "base64") {
+            // Files over 1 MB come without inline content
+            std::cerr << "Failed to download file: content not included (encoding \""
+                      << encoding << "\")" << std::endl;
+        } else if (!written) {
+            std::cerr << "Failed to write file: " << localPath << std::endl;
+        } else {
+            std::cerr << "Failed to download file: invalid content" << std::endl;
+        }
+        return false;
+    }
+    
+    void listRepositories() {
+        std::string url = routes::kUserRepos.build(baseURL, {});
+        
+        HttpResponse response = makeRequest(url, "GET");
+        if (!response.succeeded()) {
+            return;
+        }
+        
+        // The list can hold thousands of repositories; parse it into an
+        // arena over the response body instead of a node-per-allocation DOM
+        JsonDocument document;
+        if (!document.parse(response.body) || !document.root().isArray()) {
+            std::cerr << "Unexpected response from " << url << std::endl;
+            return;
+        }
+        
+        std::cout << "\nYour Repositories:" << std::endl;
+        std::cout << "==================" << std::endl;
+        
+        for (const JsonValue& repo : document.root()) {
+            std::cout << "Name: " << repo["name"].asString() << std::endl;
+            std::cout << "Description: " << repo["description"].asString() << std::endl;
+            std::cout << "URL: " << repo["html_url"].asString() << std::endl;
+            std::cout << "Private: " << (repo["private"].asBool() ? "Yes" : "No") << std::endl;
+            std::cout << "------------------" << std::endl;
+        }
+        
+        if (options.verbose) {
+            std::cout << "Parsed " << document.valueCount() << " JSON values ("
+                      << response.body.size() << " bytes) with "
+                      << document.allocationCount() << " allocations, "
+                      << document.arena().bytesUsed() << " bytes of arena, "
+                      << document.scratchBytes() << " bytes of parse stack" << std::endl;
         }
     }
     
     bool getUserInfo() {
-        std::string url = baseURL + "/user";
-        std::string response = makeRequest(url, "GET");
+        std::string url = routes::kUser.build(baseURL, {});
         
         Json::Value responseJson;
-        Json::CharReaderBuilder readerBuilder;
-        std::istringstream responseStream(response);
-        std::string errs;
-        
-        if (Json::parseFromStream(readerBuilder, responseStream, &responseJson, &errs)) {
+        if (fetchJson(url, responseJson)) {
             std::cout << "\nUser Information:" << std::endl;
             std::cout << "Username: " << responseJson["login"].asString() << std::endl;
             std::cout << "Name: " << responseJson["name"].asString() << std::endl;
@@ -240,6 +1078,7 @@ std::stringstream buffer;
 class ProjectManager {
 private:
     GitHubAPI* api;
+    ClientOptions options;
     std::string configFile = "github_config.json";
     
     void saveConfig(const std::string& token, const std::string& username) {
@@ -277,7 +1116,7 @@ private:
     }
 
 public:
-    ProjectManager() : api(nullptr) {}
+    explicit ProjectManager(const ClientOptions& _options) : api(nullptr), options(_options) {}
     
     ~ProjectManager() {
         delete api;
@@ -309,7 +1148,7 @@ public:
             saveConfig(token, username);
         }
         
-        api = new GitHubAPI(token, username);
+        api = new GitHubAPI(token, username, options);
         
         if (api->getUserInfo()) {
             std::cout << "\nAuthentication successful!" << std::endl;
@@ -327,7 +1166,8 @@ public:
         std::cout << "4. Delete file from repository" << std::endl;
         std::cout << "5. List your repositories" << std::endl;
         std::cout << "6. View user information" << std::endl;
-        std::cout << "7. Exit" << std::endl;
+        std::cout << "7. Download file from repository" << std::endl;
+        std::cout << "8. Exit" << std::endl;
         std::cout << "============================================" << std::endl;
         std::cout << "Enter your choice: ";
     }
@@ -417,7 +1257,24 @@ public:
                     api->getUserInfo();
                     break;
                 
-                case 7:
+                case 7: {
+                    std::string repoName, filePath, localPath;
+                    
+                    std::cout << "Enter repository name: ";
+                    std::getline(std::cin, repoName);
+                    
+                    std::cout << "Enter file path in repository: ";
+                    std::getline(std::cin, filePath);
+                    
+                    std::cout << "Save as: ";
+                    std::getline(std::cin, localPath);
+                    
+                    api->downloadFile(repoName, filePath, localPath);
+                    break;
+                }
+                
+                case 8:
+                    api->printConnectionStats();
                     std::cout << "Goodbye!" << std::endl;
                     break;
                 
@@ -425,104 +1282,96 @@ public:
                     std::cout << "Invalid choice. Please try again." << std::endl;
             }
             
-        } while (choice != 7);
+        } while (choice != 8);
     }
 };
 
-int main() {
-    std::cout << "========================================" << std::endl;
-    std::cout << "   GitHub Project Manager C++ Client   " << std::endl;
-    std::cout << "========================================" << std::endl;
-    
-    ProjectManager manager;
-    manager.run();
-    
-    return 0;
-}d::string response;
-        
-        if (curl) {
-            struct curl_slist* headers = nullptr;
-            headers = curl_slist_append(headers, ("Authorization: token " + token).c_str());
-            headers = curl_slist_append(headers, "User-Agent: CPP-GitHub-Client");
-            headers = curl_slist_append(headers, "Accept: application/vnd.github.v3+json");
-            headers = curl_slist_append(headers, "Content-Type: application/json");
-            
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-            
-            if (method == "POST") {
-                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-            } else if (method == "PUT") {
-                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-            } else if (method == "DELETE") {
-                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-            }
-            
-            CURLcode res = curl_easy_perform(curl);
-            
-            if (res != CURLE_OK) {
-                std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "  -j, --parallel N   Number of concurrent uploads (default 8)" << std::endl;
+    std::cout << "  --http2            Multiplex requests over one HTTP/2 connection" << std::endl;
+    std::cout << "  --max-streams N    Concurrent HTTP/2 streams per connection (default 100)" << std::endl;
+    std::cout << "  --api-url URL      API endpoint (default https://api.github.com)" << std::endl;
+    std::cout << "  --cacert FILE      CA bundle used to verify the API endpoint" << std::endl;
+    std::cout << "  --cache-dir DIR    Where conditional GET responses are cached" << std::endl;
+    std::cout << "  --no-cache         Do not cache GET responses" << std::endl;
+    std::cout << "  --no-compression   Do not request compressed responses" << std::endl;
+    std::cout << "  --retries N        Tries per request on transient errors (default 4)" << std::endl;
+    std::cout << "  --retry-budget N   Retries allowed per run (default 200)" << std::endl;
+    std::cout << "  --no-io-uring      Read files with plain syscalls instead of io_uring" << std::endl;
+    std::cout << "  --exclude PATTERN  Skip matching paths in directory uploads (repeatable)" << std::endl;
+    std::cout << "  --no-gitignore     Upload files ignored by .gitignore and .git/info/exclude" << std::endl;
+    std::cout << "  --single-commit    Upload a directory as one commit instead of one per file" << std::endl;
+    std::cout << "  -v, --verbose      Print parser statistics" << std::endl;
+    std::cout << "  -h, --help         Show this help" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], ClientOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        
+        if ((arg == "-j" || arg == "--parallel") && i + 1 < argc) {
+            options.maxInFlight = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--http2") {
+            options.transport.http2 = true;
+        } else if (arg == "--max-streams" && i + 1 < argc) {
+            options.transport.maxConcurrentStreams = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--api-url" && i + 1 < argc) {
+            options.apiURL = argv[++i];
+            while (!options.apiURL.empty() && options.apiURL.back() == '/') {
+                options.apiURL.pop_back();
             }
-            
-            curl_slist_free_all(headers);
-            curl_easy_cleanup(curl);
+        } else if (arg == "--cacert" && i + 1 < argc) {
+            options.transport.caInfo = argv[++i];
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            options.cacheDirectory = argv[++i];
+        } else if (arg == "--retries" && i + 1 < argc) {
+            options.maxAttempts = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--retry-budget" && i + 1 < argc) {
+            options.retryBudget = std::max(0L, std::atol(argv[++i]));
+        } else if (arg == "--no-compression") {
+            options.transport.compression = false;
+        } else if (arg == "--no-cache") {
+            options.cacheDirectory.clear();
+        } else if (arg == "--no-io-uring") {
+            options.ioUring = false;
+        } else if (arg == "--exclude" && i + 1 < argc) {
+            options.excludes.push_back(argv[++i]);
+        } else if (arg == "--no-gitignore") {
+            options.gitignore = false;
+        } else if (arg == "--single-commit") {
+            options.singleCommit = true;
+        } else if (arg == "-v" || arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return false;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
         }
-        
-        return response;
     }
+    
+    if (options.transport.http2 && !http2Supported()) {
+        std::cerr << "Warning: libcurl was built without HTTP/2, using HTTP/1.1" << std::endl;
+        options.transport.http2 = false;
+    }
+    return true;
+}
 
-public:
-    GitHubAPI(const std::string& _token, const std::string& _username) 
-        : token(_token), username(_username) {
-        curl_global_init(CURL_GLOBAL_DEFAULT);
+int main(int argc, char* argv[]) {
+    ClientOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
     }
     
-    ~GitHubAPI() {
-        curl_global_cleanup();
-    }
+    std::cout << "========================================" << std::endl;
+    std::cout << "   GitHub Project Manager C++ Client   " << std::endl;
+    std::cout << "========================================" << std::endl;
     
-    bool createRepository(const std::string& repoName, const std::string& description, 
-                         bool isPrivate = false) {
-        Json::Value root;
-        root["name"] = repoName;
-        root["description"] = description;
-        root["private"] = isPrivate;
-        root["auto_init"] = true;
-        
-        Json::StreamWriterBuilder writer;
-        std::string jsonData = Json::writeString(writer, root);
-        
-        std::string url = baseURL + "/user/repos";
-        std::string response = makeRequest(url, "POST", jsonData);
-        
-        Json::Value responseJson;
-        Json::CharReaderBuilder readerBuilder;
-        std::istringstream responseStream(response);
-        std::string errs;
-        
-        if (Json::parseFromStream(readerBuilder, responseStream, &responseJson, &errs)) {
-            if (responseJson.isMember("id")) {
-                std::cout << "Repository created successfully!" << std::endl;
-                std::cout << "URL: " << responseJson["html_url"].asString() << std::endl;
-                return true;
-            }
-        }
-        
-        std::cerr << "Failed to create repository: " << response << std::endl;
-        return false;
-    }
+    ProjectManager manager(options);
+    manager.run();
     
-    bool uploadFile(const std::string& repoName, const std::string& filePath, 
-                   const std::string& commitMessage) {
-        // Read file content
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "Cannot open file: " << filePath << std::endl;
-            return false;
-        }
-        
-        std::stringstream buffer;
-        buffer << file.rdbuf();
\ No newline at end of file
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "rate_limiter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+const std::chrono::milliseconds kMinMutationInterval(1000);
+const std::chrono::milliseconds kMaxMutationInterval(60000);
+const std::chrono::seconds kDefaultRetryAfter(60);
+
+bool parseLong(const std::string& text, long& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    return end && *end == '\0';
+}
+
+std::chrono::milliseconds untilThen(RateLimiter::Clock::time_point then,
+                                    RateLimiter::Clock::time_point now) {
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(then - now);
+    return std::max(wait, std::chrono::milliseconds(1));
+}
+
+}
+
+bool RateLimiter::isMutation(const std::string& method) {
+    return method == "POST" || method == "PUT" || method == "PATCH" || method == "DELETE";
+}
+
+std::chrono::milliseconds RateLimiter::reserve(const std::string& method) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+
+    Clock::time_point earliest = std::max(blockedUntil, nextStart);
+    if (isMutation(method)) {
+        earliest = std::max(earliest, nextMutation);
+    }
+    if (earliest > now) {
+        return untilThen(earliest, now);
+    }
+
+    if (remaining == 0) {
+        if (resetAt > now) {
+            return untilThen(resetAt, now);
+        }
+        // Window is over; the next response tells us the new budget
+        remaining = -1;
+    }
+
+    if (remaining > 0) {
+        remaining--;
+        if (limit > 0 && remaining < limit / 10 && resetAt > now) {
+            nextStart = now + (resetAt - now) / (remaining + 1);
+        }
+    }
+    if (isMutation(method)) {
+        nextMutation = now + mutationInterval;
+    }
+    return std::chrono::milliseconds(0);
+}
+
+void RateLimiter::acquire(const std::string& method) {
+    while (true) {
+        std::chrono::milliseconds wait = reserve(method);
+        if (wait.count() == 0) {
+            return;
+        }
+        std::this_thread::sleep_for(wait);
+    }
+}
+
+void RateLimiter::blockFor(std::chrono::milliseconds duration, const char* reason) {
+    Clock::time_point until = Clock::now() + duration;
+    if (until > blockedUntil + std::chrono::seconds(1)) {
+        std::cerr << "Rate limited (" << reason << "), pausing requests for "
+                  << std::chrono::ceil<std::chrono::seconds>(duration).count() << "s"
+                  << std::endl;
+    }
+    blockedUntil = std::max(blockedUntil, until);
+}
+
+bool RateLimiter::update(const std::string& method, const HttpResponse& response) {
+    if (response.result != CURLE_OK) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+
+    long headerLimit = 0;
+    long headerRemaining = 0;
+    long headerReset = 0;
+    bool hasBudget = parseLong(response.header("x-ratelimit-remaining"), headerRemaining) &&
+                     parseLong(response.header("x-ratelimit-reset"), headerReset);
+    if (hasBudget) {
+        if (parseLong(response.header("x-ratelimit-limit"), headerLimit)) {
+            limit = headerLimit;
+        }
+        if (headerReset != resetEpoch) {
+            // New window: take the server's numbers as they are
+            resetEpoch = headerReset;
+            remaining = headerRemaining;
+            long secondsLeft = std::max(0L, headerReset - static_cast<long>(std::time(nullptr)));
+            resetAt = now + std::chrono::seconds(secondsLeft);
+        } else if (response.status == 304 && remaining >= 0) {
+            // Revalidations are free; give back the slot reserve() took
+            remaining++;
+        } else if (remaining < 0 || headerRemaining < remaining) {
+            // Same window: our estimate already accounts for requests in flight
+            remaining = headerRemaining;
+        }
+    }
+
+    if (response.status != 403 && response.status != 429) {
+        if (response.succeeded() && isMutation(method) && mutationInterval.count() > 0) {
+            mutationInterval -= mutationInterval / 8;
+            if (mutationInterval < std::chrono::milliseconds(50)) {
+                mutationInterval = std::chrono::milliseconds(0);
+            }
+        }
+        return false;
+    }
+
+    long retryAfter = 0;
+    bool secondary = parseLong(response.header("retry-after"), retryAfter) ||
+                     response.body.find("secondary rate limit") != std::string::npos;
+
+    if (secondary) {
+        std::chrono::milliseconds wait = retryAfter > 0
+            ? std::chrono::milliseconds(std::chrono::seconds(retryAfter))
+            : std::chrono::milliseconds(kDefaultRetryAfter);
+        blockFor(wait, "secondary limit");
+        mutationInterval = std::clamp(mutationInterval * 2, kMinMutationInterval,
+                                      kMaxMutationInterval);
+    } else if (hasBudget && headerRemaining == 0) {
+        blockFor(std::chrono::ceil<std::chrono::milliseconds>(resetAt - now) +
+                     std::chrono::seconds(1),
+                 "hourly budget used up");
+    } else {
+        // A plain 403 (permissions, bad token) is not ours to retry
+        return false;
+    }
+
+    throttled++;
+    return true;
+}
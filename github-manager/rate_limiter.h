@@ -0,0 +1,52 @@
+#ifndef GITHUB_MANAGER_RATE_LIMITER_H
+#define GITHUB_MANAGER_RATE_LIMITER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include "http_transport.h"
+
+// Schedules requests against GitHub's rate limits.
+//
+// The primary budget is tracked from X-RateLimit-Remaining/Reset. While
+// more than a tenth of it is left requests go out freely; below that the
+// rest is spread evenly until the window resets, and at zero requests wait
+// for the reset. Secondary limits (403/429 with Retry-After, or the
+// "secondary rate limit" message) pause all requests for the advertised
+// time and pace mutating requests with an interval that doubles on every
+// hit and decays again on success.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Zero if a request with this method may start now (the slot is then
+    // taken), otherwise how long to wait before asking again.
+    std::chrono::milliseconds reserve(const std::string& method);
+
+    // Blocks until a request with this method may start.
+    void acquire(const std::string& method);
+
+    // Feeds a finished response back. Returns true if the request was
+    // rejected by a rate limit and should be replayed.
+    bool update(const std::string& method, const HttpResponse& response);
+
+    long throttledCount() const { return throttled.load(); }
+
+private:
+    static bool isMutation(const std::string& method);
+    void blockFor(std::chrono::milliseconds duration, const char* reason);
+
+    std::mutex mutex;
+    long limit = -1;
+    long remaining = -1;
+    long resetEpoch = 0;
+    Clock::time_point resetAt;
+    Clock::time_point blockedUntil;
+    Clock::time_point nextStart;
+    Clock::time_point nextMutation;
+    std::chrono::milliseconds mutationInterval{0};
+    std::atomic<long> throttled{0};
+};
+
+#endif
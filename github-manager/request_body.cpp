@@ -0,0 +1,126 @@
+#include "request_body.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "base64.h"
+
+namespace {
+
+// Raw bytes encoded per refill
+const size_t kRawChunk = 48 * 1024;
+
+size_t readBody(char* buffer, size_t size, size_t nitems, void* userdata) {
+    RequestBody* body = static_cast<RequestBody*>(userdata);
+    size_t written = body->read(buffer, size * nitems);
+    if (body->failed()) {
+        return CURL_READFUNC_ABORT;
+    }
+    return written;
+}
+
+int seekBody(void* userdata, curl_off_t offset, int origin) {
+    RequestBody* body = static_cast<RequestBody*>(userdata);
+    // Only rewinding to the start is needed (redirects, auth retries)
+    if (offset != 0 || origin != SEEK_SET || !body->rewind()) {
+        return CURL_SEEKFUNC_CANTSEEK;
+    }
+    return CURL_SEEKFUNC_OK;
+}
+
+}
+
+void attachRequestBody(CURL* curl, RequestBody& body) {
+    curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, readBody);
+    curl_easy_setopt(curl, CURLOPT_READDATA, &body);
+    curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, seekBody);
+    curl_easy_setopt(curl, CURLOPT_SEEKDATA, &body);
+    curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(body.size()));
+}
+
+ContentsUploadBody::ContentsUploadBody(const std::string& localPath,
+                                       const ContentsPayload& payload)
+    : source(localPath), prefix(payload.head()), suffix(payload.tail()),
+      encoded(Base64Encoder::maxOutput(kRawChunk)), pinned(!payload.sha.empty()) {}
+
+long long ContentsUploadBody::size() const {
+    long long encodedSize = static_cast<long long>(base64EncodedSize(source.size()));
+    return static_cast<long long>(prefix.size()) + encodedSize +
+           static_cast<long long>(suffix.size());
+}
+
+bool ContentsUploadBody::rewind() {
+    if (!source.rewind()) {
+        return false;
+    }
+    phase = Phase::Prefix;
+    offset = 0;
+    encodedLength = 0;
+    encoder.reset();
+    encoderDone = false;
+    error = false;
+    return true;
+}
+
+bool ContentsUploadBody::refill() {
+    if (encoderDone) {
+        return false;
+    }
+
+    // The announced Content-Length must hold; a file that shrank
+    // underneath us would corrupt the request
+    const char* data;
+    size_t length;
+    if (source.next(data, length, kRawChunk)) {
+        encodedLength = encoder.update(data, length, encoded.data());
+    } else if (source.failed()) {
+        error = true;
+        return false;
+    } else {
+        encodedLength = encoder.finish(encoded.data());
+        encoderDone = true;
+    }
+    offset = 0;
+    return encodedLength > 0 || !encoderDone;
+}
+
+size_t ContentsUploadBody::read(char* buffer, size_t size) {
+    size_t written = 0;
+
+    while (written < size && phase != Phase::Done && !error) {
+        switch (phase) {
+            case Phase::Prefix:
+            case Phase::Suffix: {
+                const std::string& text = phase == Phase::Prefix ? prefix : suffix;
+                size_t n = std::min(size - written, text.size() - offset);
+                std::memcpy(buffer + written, text.data() + offset, n);
+                written += n;
+                offset += n;
+                if (offset == text.size()) {
+                    phase = phase == Phase::Prefix ? Phase::Content : Phase::Done;
+                    offset = 0;
+                    encodedLength = 0;
+                }
+                break;
+            }
+            case Phase::Content: {
+                if (offset == encodedLength && !refill()) {
+                    if (!error) {
+                        phase = Phase::Suffix;
+                        offset = 0;
+                    }
+                    break;
+                }
+                size_t n = std::min(size - written, encodedLength - offset);
+                std::memcpy(buffer + written, encoded.data() + offset, n);
+                written += n;
+                offset += n;
+                break;
+            }
+            case Phase::Done:
+                break;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,75 @@
+#ifndef GITHUB_MANAGER_REQUEST_BODY_H
+#define GITHUB_MANAGER_REQUEST_BODY_H
+
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include "base64.h"
+#include "contents_payload.h"
+#include "file_source.h"
+
+// Request body produced on demand while it is being sent, instead of being
+// assembled in memory up front.
+class RequestBody {
+public:
+    virtual ~RequestBody() = default;
+
+    // Exact length in bytes, sent as Content-Length.
+    virtual long long size() const = 0;
+
+    // Fills up to size bytes and returns how many were written; 0 at the end.
+    virtual size_t read(char* buffer, size_t size) = 0;
+
+    // Starts over from the first byte, for retries. False if not possible.
+    virtual bool rewind() = 0;
+
+    // True once read() hit an error; the transfer is then aborted.
+    virtual bool failed() const = 0;
+
+    // True if the body names the sha of the version it replaces.
+    virtual bool conditional() const { return false; }
+};
+
+// Makes the next transfer on curl send body via a read callback. Sets
+// CURLOPT_UPLOAD, so the method is PUT unless CURLOPT_CUSTOMREQUEST says
+// otherwise.
+void attachRequestBody(CURL* curl, RequestBody& body);
+
+// Contents API PUT body (see ContentsPayload), with the file
+// base64-encoded span by span as curl asks for data. Memory use is
+// a fixed-size buffer regardless of the file size.
+class ContentsUploadBody : public RequestBody {
+public:
+    ContentsUploadBody(const std::string& localPath, const ContentsPayload& payload);
+    ContentsUploadBody(const ContentsUploadBody&) = delete;
+    ContentsUploadBody& operator=(const ContentsUploadBody&) = delete;
+
+    bool isOpen() const { return source.isOpen(); }
+
+    long long size() const override;
+    size_t read(char* buffer, size_t size) override;
+    bool rewind() override;
+    bool failed() const override { return error; }
+    bool conditional() const override { return pinned; }
+
+private:
+    enum class Phase { Prefix, Content, Suffix, Done };
+
+    // Encodes the next span of the file; false once everything, including
+    // the padding, has been produced or on error.
+    bool refill();
+
+    FileSource source;
+    std::string prefix;
+    std::string suffix;
+    Phase phase = Phase::Prefix;
+    size_t offset = 0;
+    std::vector<char> encoded;
+    size_t encodedLength = 0;
+    Base64Encoder encoder;
+    bool encoderDone = false;
+    bool error = false;
+    bool pinned;
+};
+
+#endif
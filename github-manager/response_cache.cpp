@@ -0,0 +1,149 @@
+#include "response_cache.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <system_error>
+#include <unistd.h>
+#include <openssl/evp.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string sha256Hex(const std::string& data) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    if (!EVP_Digest(data.data(), data.size(), digest, &length, EVP_sha256(), nullptr)) {
+        return "";
+    }
+
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(length * 2);
+    for (unsigned int i = 0; i < length; i++) {
+        hex += hexDigits[digest[i] >> 4];
+        hex += hexDigits[digest[i] & 0x0f];
+    }
+    return hex;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}
+
+ResponseCache::ResponseCache(const std::string& _directory, const std::string& _token)
+    : directory(_directory), token(_token) {
+    if (directory.empty()) {
+        return;
+    }
+
+    // Entries are authenticated responses (private repositories, file
+    // contents), so only the owner may read them. A directory we create is
+    // made private; an existing one is used only if it already is, rather
+    // than changing the mode of a directory the user may share
+    std::error_code ec;
+    bool created = fs::create_directories(directory, ec);
+    if (!ec && created) {
+        fs::permissions(directory, fs::perms::owner_all, fs::perm_options::replace, ec);
+    }
+    if (ec) {
+        directory.clear();
+        return;
+    }
+    fs::perms mode = fs::status(directory, ec).permissions();
+    if (ec || (mode & (fs::perms::group_all | fs::perms::others_all)) != fs::perms::none) {
+        std::cerr << "Warning: response cache disabled; " << directory
+                  << " is accessible to other users (chmod 700 it, or pass --cache-dir)"
+                  << std::endl;
+        directory.clear();
+    }
+}
+
+std::string ResponseCache::defaultDirectory() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+        if (*xdg) {
+            return (fs::path(xdg) / "github-manager").string();
+        }
+    }
+    if (const char* home = std::getenv("HOME")) {
+        if (*home) {
+            return (fs::path(home) / ".cache" / "github-manager").string();
+        }
+    }
+    return "";
+}
+
+std::string ResponseCache::pathFor(const std::string& url) const {
+    return (fs::path(directory) / sha256Hex(token + "\n" + url)).string();
+}
+
+bool ResponseCache::load(const std::string& url, Entry& entry) const {
+    if (!enabled()) {
+        return false;
+    }
+
+    std::ifstream file(pathFor(url), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Layout: ETag line, Last-Modified line, then the raw body
+    if (!std::getline(file, entry.etag) || !std::getline(file, entry.lastModified)) {
+        return false;
+    }
+    entry.body.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !entry.etag.empty() || !entry.lastModified.empty();
+}
+
+void ResponseCache::store(const std::string& url, const HttpResponse& response) {
+    // A transfer that failed part way may have left a truncated body
+    if (!enabled() || response.result != CURLE_OK || response.status != 200) {
+        return;
+    }
+
+    std::string etag = response.header("etag");
+    std::string lastModified = response.header("last-modified");
+    if (etag.empty() && lastModified.empty()) {
+        return;
+    }
+
+    // Write to a temporary file and rename, so readers never see half an
+    // entry. mkstemp creates it exclusively with mode 0600.
+    std::string path = pathFor(url);
+    std::string tempPath = path + ".XXXXXX";
+    int fd = ::mkstemp(&tempPath[0]);
+    if (fd < 0) {
+        return;
+    }
+    std::string header = etag + '\n' + lastModified + '\n';
+    bool written = writeAll(fd, header.data(), header.size()) &&
+                   writeAll(fd, response.body.data(), response.body.size());
+    written = ::close(fd) == 0 && written;
+
+    std::error_code ec;
+    if (!written) {
+        fs::remove(tempPath, ec);
+        return;
+    }
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef GITHUB_MANAGER_RESPONSE_CACHE_H
+#define GITHUB_MANAGER_RESPONSE_CACHE_H
+
+#include <atomic>
+#include <string>
+#include "http_transport.h"
+
+// On-disk cache of GET responses for conditional requests.
+//
+// Entries are keyed by SHA-256(token + URL), so different accounts never
+// see each other's data and the token itself is never written to disk.
+// Each entry keeps the ETag/Last-Modified validators next to the body; the
+// caller revalidates with If-None-Match/If-Modified-Since and serves the
+// stored body on 304 Not Modified, which GitHub does not bill against the
+// rate limit.
+class ResponseCache {
+public:
+    struct Entry {
+        std::string etag;
+        std::string lastModified;
+        std::string body;
+    };
+
+    // An empty directory disables the cache, and so does an existing one
+    // that group or other users can access (a new one is created 0700).
+    ResponseCache(const std::string& directory, const std::string& token);
+
+    bool enabled() const { return !directory.empty(); }
+
+    bool load(const std::string& url, Entry& entry) const;
+
+    // Stores a complete 200 response if it carries a validator.
+    void store(const std::string& url, const HttpResponse& response);
+
+    void recordRevalidation() { revalidated++; }
+    long revalidatedCount() const { return revalidated.load(); }
+
+    // $XDG_CACHE_HOME/github-manager or ~/.cache/github-manager, or "" if
+    // neither variable is set.
+    static std::string defaultDirectory();
+
+private:
+    std::string pathFor(const std::string& url) const;
+
+    std::string directory;
+    std::string token;
+    std::atomic<long> revalidated{0};
+};
+
+#endif
@@ -0,0 +1,187 @@
+#include "response_sink.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Guards against a bogus Content-Length reserving absurd amounts of memory
+const long long kMaxReserve = 256LL * 1024 * 1024;
+
+// Base64 characters collected before they are decoded in one go
+const size_t kContentStage = 64 * 1024;
+
+}
+
+void StringSink::expect(long long contentLength) {
+    if (contentLength > 0 && contentLength <= kMaxReserve) {
+        target.reserve(target.size() + static_cast<size_t>(contentLength));
+    }
+}
+
+bool StringSink::write(const char* data, size_t size) {
+    target.append(data, size);
+    return true;
+}
+
+FileSink::FileSink(const std::string& path) : file(std::fopen(path.c_str(), "wb")) {
+}
+
+FileSink::~FileSink() {
+    close();
+}
+
+bool FileSink::write(const char* data, size_t size) {
+    if (!file || std::fwrite(data, 1, size, file) != size) {
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool FileSink::close() {
+    if (file) {
+        if (std::fclose(file) != 0) {
+            failed = true;
+        }
+        file = nullptr;
+    }
+    return !failed;
+}
+
+ContentsDecodeSink::ContentsDecodeSink(ResponseSink& _target)
+    : target(_target), output(Base64Decoder::maxOutput(kContentStage)) {
+    stage.reserve(kContentStage);
+}
+
+void ContentsDecodeSink::scanDocument(char c) {
+    document += c;
+
+    if (inString) {
+        if (escaped) {
+            escaped = false;
+        } else if (c == '\\') {
+            escaped = true;
+        } else if (c == '"') {
+            inString = false;
+            contentKey = depth == 1 && lastString == "content";
+            return;
+        }
+        // Only short strings can be the key we look for
+        if (lastString.size() < 16) {
+            lastString += c;
+        }
+        return;
+    }
+
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        return;
+    }
+    if (c == ':' && contentKey) {
+        contentKey = false;
+        contentValue = true;
+        return;
+    }
+    if (c == '"') {
+        if (contentValue && !contentDone) {
+            contentValue = false;
+            state = State::Content;
+            return;
+        }
+        inString = true;
+        lastString.clear();
+    } else if (c == '{' || c == '[') {
+        depth++;
+    } else if (c == '}' || c == ']') {
+        depth--;
+    }
+    contentKey = false;
+    contentValue = false;
+}
+
+bool ContentsDecodeSink::stageContent(const char* data, size_t size) {
+    while (size > 0) {
+        size_t n = std::min(size, kContentStage - stage.size());
+        stage.insert(stage.end(), data, data + n);
+        data += n;
+        size -= n;
+        if (stage.size() == kContentStage && !flushStage()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ContentsDecodeSink::flushStage() {
+    size_t written = 0;
+    if (!decoder.update(stage.data(), stage.size(), output.data(), written) ||
+        !target.write(output.data(), written)) {
+        failed = true;
+        return false;
+    }
+    decoded += static_cast<long long>(written);
+    stage.clear();
+    return true;
+}
+
+bool ContentsDecodeSink::write(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size && !failed) {
+        if (state == State::Document) {
+            scanDocument(data[i++]);
+            continue;
+        }
+
+        if (state == State::ContentEscape) {
+            // The API escapes its line breaks; "\/" is a legal spelling of '/'
+            char c = data[i++];
+            if (c == '/') {
+                stageContent("/", 1);
+            } else if (c != 'n' && c != 'r' && c != 't') {
+                failed = true;
+            }
+            state = State::Content;
+            continue;
+        }
+
+        // Inside the content string: copy runs up to the next escape, and
+        // look for the closing quote only within each run
+        const char* run = data + i;
+        size_t length = size - i;
+        const char* backslash = static_cast<const char*>(std::memchr(run, '\\', length));
+        if (backslash) {
+            length = static_cast<size_t>(backslash - run);
+        }
+        const char* quote = static_cast<const char*>(std::memchr(run, '"', length));
+        if (quote) {
+            stageContent(run, static_cast<size_t>(quote - run));
+            i += static_cast<size_t>(quote - run) + 1;
+            if (flushStage()) {
+                document += '"';
+                contentDone = true;
+                state = State::Document;
+            }
+        } else if (backslash) {
+            stageContent(run, length);
+            i += length + 1;
+            state = State::ContentEscape;
+        } else {
+            stageContent(run, length);
+            i = size;
+        }
+    }
+    return !failed;
+}
+
+bool ContentsDecodeSink::finish() {
+    if (failed || !contentDone) {
+        return false;
+    }
+    size_t written = 0;
+    if (!decoder.finish(output.data(), written) || !target.write(output.data(), written)) {
+        failed = true;
+        return false;
+    }
+    decoded += static_cast<long long>(written);
+    return true;
+}
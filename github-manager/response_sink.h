@@ -0,0 +1,116 @@
+#ifndef GITHUB_MANAGER_RESPONSE_SINK_H
+#define GITHUB_MANAGER_RESPONSE_SINK_H
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include "base64.h"
+
+// Destination for a response body, fed chunk by chunk as it arrives.
+class ResponseSink {
+public:
+    virtual ~ResponseSink() = default;
+
+    // Called when the headers are complete and announce a Content-Length.
+    virtual void expect(long long contentLength) { (void)contentLength; }
+
+    // Consumes the next chunk. Returning false aborts the transfer.
+    virtual bool write(const char* data, size_t size) = 0;
+};
+
+// Collects the body in a string, sized up front when the length is known.
+class StringSink : public ResponseSink {
+public:
+    explicit StringSink(std::string& _target) : target(_target) {}
+
+    void expect(long long contentLength) override;
+    bool write(const char* data, size_t size) override;
+
+private:
+    std::string& target;
+};
+
+// Drops the body; for requests where only the status matters.
+class DiscardSink : public ResponseSink {
+public:
+    bool write(const char*, size_t) override { return true; }
+};
+
+// Writes the body straight into a file.
+class FileSink : public ResponseSink {
+public:
+    explicit FileSink(const std::string& path);
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+    ~FileSink() override;
+
+    bool isOpen() const { return file != nullptr; }
+    bool write(const char* data, size_t size) override;
+    // Flushes and closes; false if any write failed.
+    bool close();
+
+private:
+    FILE* file;
+    bool failed = false;
+};
+
+// Hands every chunk to a callback, e.g. an incremental parser.
+class ChunkSink : public ResponseSink {
+public:
+    using Consumer = std::function<bool(const char* data, size_t size)>;
+
+    explicit ChunkSink(Consumer _consumer) : consumer(std::move(_consumer)) {}
+
+    bool write(const char* data, size_t size) override { return consumer(data, size); }
+
+private:
+    Consumer consumer;
+};
+
+// Pulls the base64 "content" string out of a contents API response while it
+// streams in, decodes it and passes the bytes on to target, so a download
+// never holds the file in memory. The rest of the document is small and is
+// kept, with the content string emptied, for reading "sha" or "encoding"
+// afterwards.
+class ContentsDecodeSink : public ResponseSink {
+public:
+    explicit ContentsDecodeSink(ResponseSink& _target);
+
+    bool write(const char* data, size_t size) override;
+    // Decodes what is still buffered. False if the document had no content
+    // string or it was not valid base64.
+    bool finish();
+
+    const std::string& metadata() const { return document; }
+    long long decodedSize() const { return decoded; }
+
+private:
+    enum class State { Document, Content, ContentEscape };
+
+    // One character of the document outside the content string
+    void scanDocument(char c);
+    bool stageContent(const char* data, size_t size);
+    bool flushStage();
+
+    ResponseSink& target;
+    Base64Decoder decoder;
+    State state = State::Document;
+    std::string document;
+
+    // Just enough tokenizing to find the top-level "content" key
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    std::string lastString;
+    bool contentKey = false;     // "content" key read, ':' expected
+    bool contentValue = false;   // ':' read, value expected
+    bool contentDone = false;
+
+    std::vector<char> stage;
+    std::vector<char> output;
+    long long decoded = 0;
+    bool failed = false;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "retry_policy.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+const std::chrono::milliseconds kBaseDelay(500);
+const std::chrono::milliseconds kMaxDelay(30000);
+
+// The request never reached the server, so replaying it cannot duplicate it
+bool failedBeforeSending(CURLcode result) {
+    return result == CURLE_COULDNT_RESOLVE_HOST || result == CURLE_COULDNT_RESOLVE_PROXY ||
+           result == CURLE_COULDNT_CONNECT;
+}
+
+}
+
+bool RetryPolicy::isTransient(const HttpResponse& response) {
+    switch (response.result) {
+        case CURLE_OK:
+            break;
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_RESOLVE_PROXY:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_GOT_NOTHING:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_SSL_CONNECT_ERROR:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+            return true;
+        default:
+            return false;
+    }
+
+    return response.status == 500 || response.status == 502 ||
+           response.status == 503 || response.status == 504;
+}
+
+bool RetryPolicy::isReplaySafe(const std::string& method, const std::string& url,
+                               bool conditional, const HttpResponse& response) {
+    if (failedBeforeSending(response.result)) {
+        return true;
+    }
+    if (method == "GET" || method == "HEAD" || method == "DELETE") {
+        return true;
+    }
+    // Without a sha a replayed PUT may land after another writer's
+    if (method == "PUT" && url.find("/contents/") != std::string::npos) {
+        return conditional;
+    }
+    // A repeated commit is just left unreferenced
+    if (method == "POST") {
+        return url.find("/git/blobs") != std::string::npos ||
+               url.find("/git/trees") != std::string::npos ||
+               url.find("/git/commits") != std::string::npos;
+    }
+    return method == "PATCH" && url.find("/git/refs/") != std::string::npos;
+}
+
+std::chrono::milliseconds RetryPolicy::backoff(int attempt, std::chrono::seconds retryAfter) const {
+    thread_local std::mt19937 random(std::random_device{}());
+
+    // Full jitter: uniform in [0, min(cap, base * 2^(attempt - 1))]
+    long long ceiling = kBaseDelay.count() << std::min(attempt - 1, 16);
+    ceiling = std::min<long long>(ceiling, kMaxDelay.count());
+    std::uniform_int_distribution<long long> jitter(0, ceiling);
+    std::chrono::milliseconds delay(jitter(random));
+
+    return std::max<std::chrono::milliseconds>(delay, retryAfter);
+}
+
+bool RetryPolicy::shouldRetry(const std::string& method, const std::string& url,
+                              bool conditional, const HttpResponse& response, int attempt,
+                              std::chrono::milliseconds& delay) {
+    if (attempt >= maxAttempts || !isTransient(response) ||
+        !isReplaySafe(method, url, conditional, response)) {
+        return false;
+    }
+
+    // A 503 may say how long the server wants to be left alone. That is
+    // honoured as given; if it is longer than we are willing to wait, the
+    // request fails now rather than being sent early.
+    std::chrono::seconds retryAfter(std::max(0L, std::atol(response.header("retry-after").c_str())));
+    if (retryAfter > kMaxDelay) {
+        return false;
+    }
+
+    // Take one retry from the shared budget, unless it is already spent
+    long left = budget.load();
+    do {
+        if (left <= 0) {
+            return false;
+        }
+    } while (!budget.compare_exchange_weak(left, left - 1));
+
+    retried++;
+    delay = backoff(attempt, retryAfter);
+    return true;
+}
@@ -0,0 +1,51 @@
+#ifndef GITHUB_MANAGER_RETRY_POLICY_H
+#define GITHUB_MANAGER_RETRY_POLICY_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "http_transport.h"
+
+// Decides whether a failed request is replayed and when.
+//
+// Only transient failures are retried: 5xx gateway/server errors, resets,
+// timeouts and connection failures. A request is replayed only if doing so
+// cannot apply it twice. Failures before the request went out (DNS,
+// connect) are safe for any method. Otherwise GET/HEAD and DELETE
+// (guarded by the blob sha) are safe. A PUT /contents/ is safe only when
+// its body names the sha of the blob it replaces, since the API then
+// applies it conditionally; callers say so with conditional. Git Data
+// API posts (blobs, trees, commits) are safe because objects are addressed
+// by content, and so is a fast-forward-only ref update. Waits use
+// exponential backoff with full jitter, or the server's Retry-After as
+// given; a Retry-After longer than the backoff cap ends the retries. All requests of a run draw from one
+// retry budget, so a dead endpoint cannot multiply the run time.
+class RetryPolicy {
+public:
+    RetryPolicy(int _maxAttempts, long _budget)
+        : maxAttempts(_maxAttempts), budget(_budget) {}
+
+    // If the request should be replayed, takes one retry from the budget and
+    // returns true with the time to wait in delay. attempt counts the tries
+    // already made (1 after the first failure).
+    // conditional is true if the body pins the version it replaces (a sha).
+    bool shouldRetry(const std::string& method, const std::string& url, bool conditional,
+                     const HttpResponse& response, int attempt,
+                     std::chrono::milliseconds& delay);
+
+    long retriedCount() const { return retried.load(); }
+    long budgetLeft() const { return budget.load(); }
+
+    static bool isTransient(const HttpResponse& response);
+    static bool isReplaySafe(const std::string& method, const std::string& url,
+                             bool conditional, const HttpResponse& response);
+
+private:
+    std::chrono::milliseconds backoff(int attempt, std::chrono::seconds retryAfter) const;
+
+    int maxAttempts;
+    std::atomic<long> budget;
+    std::atomic<long> retried{0};
+};
+
+#endif
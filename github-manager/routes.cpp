@@ -0,0 +1,56 @@
+#include "routes.h"
+
+#include <cstring>
+#include "url_encode.h"
+
+namespace {
+
+// Calls literal(text) for each run of fixed text and value(index, keepSlash)
+// for each placeholder, in order
+template <typename Literal, typename Value>
+void walkPattern(std::string_view pattern, Literal literal, Value value) {
+    size_t index = 0;
+    size_t at = 0;
+    while (at < pattern.size()) {
+        size_t open = pattern.find('{', at);
+        if (open == std::string_view::npos) {
+            literal(pattern.substr(at));
+            return;
+        }
+        literal(pattern.substr(at, open - at));
+        size_t close = pattern.find('}', open);
+        value(index++, pattern[open + 1] == '+');
+        at = close + 1;
+    }
+}
+
+}
+
+std::string expandRoute(std::string_view base, std::string_view pattern,
+                        const std::string_view* values, size_t count) {
+    // First pass sizes the URL, the second writes it in place
+    size_t size = base.size();
+    walkPattern(pattern,
+                [&](std::string_view text) { size += text.size(); },
+                [&](size_t index, bool keepSlash) {
+                    if (index < count) {
+                        size += percentEncodedSize(values[index], keepSlash);
+                    }
+                });
+
+    std::string url(size, '\0');
+    char* out = &url[0];
+    std::memcpy(out, base.data(), base.size());
+    out += base.size();
+    walkPattern(pattern,
+                [&](std::string_view text) {
+                    std::memcpy(out, text.data(), text.size());
+                    out += text.size();
+                },
+                [&](size_t index, bool keepSlash) {
+                    if (index < count) {
+                        out = percentEncode(values[index], keepSlash, out);
+                    }
+                });
+    return url;
+}
@@ -0,0 +1,78 @@
+#ifndef GITHUB_MANAGER_ROUTES_H
+#define GITHUB_MANAGER_ROUTES_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Builds base + pattern with each placeholder replaced by the next value,
+// percent-encoded. "{name}" is a single path segment, so '/' is escaped;
+// "{+name}" may span segments and keeps '/'. The result is sized exactly
+// before it is written, so building a URL is one allocation.
+std::string expandRoute(std::string_view base, std::string_view pattern,
+                        const std::string_view* values, size_t count);
+
+// An API route such as "/repos/{owner}/{repo}/contents/{+path}". Routes
+// are constants checked by the compiler (see valid()); build() takes
+// exactly Parameters values.
+template <size_t Parameters>
+class Route {
+public:
+    constexpr explicit Route(std::string_view _pattern) : pattern(_pattern) {}
+
+    // Braces balanced, no empty names, and Parameters placeholders
+    constexpr bool valid() const {
+        size_t found = 0;
+        bool open = false;
+        size_t nameStart = 0;
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if (pattern[i] == '{') {
+                if (open) {
+                    return false;
+                }
+                open = true;
+                nameStart = i + 1 < pattern.size() && pattern[i + 1] == '+' ? i + 2 : i + 1;
+            } else if (pattern[i] == '}') {
+                if (!open || i == nameStart) {
+                    return false;
+                }
+                open = false;
+                found++;
+            }
+        }
+        return !open && found == Parameters;
+    }
+
+    std::string build(std::string_view base,
+                      const std::array<std::string_view, Parameters>& values) const {
+        return expandRoute(base, pattern, values.data(), values.size());
+    }
+
+private:
+    std::string_view pattern;
+};
+
+namespace routes {
+
+constexpr Route<0> kUser("/user");
+constexpr Route<0> kUserRepos("/user/repos");
+constexpr Route<3> kContents("/repos/{owner}/{repo}/contents/{+path}");
+constexpr Route<3> kTree("/repos/{owner}/{repo}/git/trees/{sha}?recursive=1");
+
+// Git Data API, for committing a whole directory at once
+constexpr Route<2> kRepository("/repos/{owner}/{repo}");
+constexpr Route<3> kBranch("/repos/{owner}/{repo}/branches/{+branch}");
+constexpr Route<2> kBlobs("/repos/{owner}/{repo}/git/blobs");
+constexpr Route<2> kTrees("/repos/{owner}/{repo}/git/trees");
+constexpr Route<2> kCommits("/repos/{owner}/{repo}/git/commits");
+constexpr Route<3> kBranchRef("/repos/{owner}/{repo}/git/refs/heads/{+branch}");
+
+static_assert(kUser.valid() && kUserRepos.valid(), "malformed route");
+static_assert(kContents.valid() && kTree.valid(), "malformed route");
+static_assert(kRepository.valid() && kBranch.valid() && kBlobs.valid(), "malformed route");
+static_assert(kTrees.valid() && kCommits.valid() && kBranchRef.valid(), "malformed route");
+
+}
+
+#endif
@@ -0,0 +1,404 @@
+#include "sha1_batch.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GITHUB_MANAGER_SHA1_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const size_t kMaxLanes = 16;
+
+const uint32_t kInitial[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+const uint32_t kRound[4] = {0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6};
+
+// Runs one 64-byte block through the compression function for every lane.
+// Both arrays are lane-interleaved: word i of lane j is at [i * lanes + j].
+// Block words are already in big-endian order.
+typedef void (*Compress)(uint32_t* state, const uint32_t* block);
+
+struct Kernel {
+    const char* name;
+    size_t lanes;
+    Compress compress;
+    bool (*supported)();
+};
+
+inline uint32_t rotl(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+void compressScalar(uint32_t* state, const uint32_t* block) {
+    uint32_t w[16];
+    std::memcpy(w, block, sizeof(w));
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+#pragma GCC unroll 80
+    for (int t = 0; t < 80; t++) {
+        if (t >= 16) {
+            w[t & 15] = rotl(w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15] ^ w[t & 15], 1);
+        }
+        uint32_t f;
+        if (t < 20) {
+            f = d ^ (b & (c ^ d));
+        } else if (t < 40 || t >= 60) {
+            f = b ^ c ^ d;
+        } else {
+            f = (b & c) | (d & (b | c));
+        }
+        uint32_t temp = rotl(a, 5) + f + e + kRound[t / 20] + w[t & 15];
+        e = d;
+        d = c;
+        c = rotl(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+bool always() {
+    return true;
+}
+
+#ifdef GITHUB_MANAGER_SHA1_X86
+
+// SHA-NI: four rounds per instruction, with the message schedule computed
+// by sha1msg1/sha1msg2. Registers hold words in reverse order (a in the
+// top lane), as the instructions expect.
+__attribute__((target("sha,sse4.1")))
+void compressSHANI(uint32_t* state, const uint32_t* block) {
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+    __m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+    const __m128i abcdSave = abcd;
+    const __m128i eSave = e0;
+
+    __m128i msg[4];
+    for (int i = 0; i < 4; i++) {
+        msg[i] = _mm_shuffle_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 4 * i)), 0x1b);
+    }
+
+    __m128i e = _mm_add_epi32(e0, msg[0]);
+    __m128i previous = abcd;
+    // Unrolled, the indices and the switch below become constants
+#pragma GCC unroll 20
+    for (int i = 0; i < 20; i++) {
+        if (i >= 4) {
+            __m128i& w = msg[i & 3];
+            w = _mm_sha1msg1_epu32(w, msg[(i + 1) & 3]);
+            w = _mm_xor_si128(w, msg[(i + 2) & 3]);
+            w = _mm_sha1msg2_epu32(w, msg[(i + 3) & 3]);
+        }
+        if (i > 0) {
+            e = _mm_sha1nexte_epu32(previous, msg[i & 3]);
+        }
+        previous = abcd;
+        // The round function selector must be an immediate
+        switch (i / 5) {
+            case 0: abcd = _mm_sha1rnds4_epu32(abcd, e, 0); break;
+            case 1: abcd = _mm_sha1rnds4_epu32(abcd, e, 1); break;
+            case 2: abcd = _mm_sha1rnds4_epu32(abcd, e, 2); break;
+            default: abcd = _mm_sha1rnds4_epu32(abcd, e, 3); break;
+        }
+    }
+
+    e0 = _mm_sha1nexte_epu32(previous, eSave);
+    abcd = _mm_add_epi32(abcd, abcdSave);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+__attribute__((target("avx2"), always_inline))
+inline __m256i rotl8(__m256i x, int n) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n));
+}
+
+// Eight messages at once, one per 32-bit lane: the plain SHA-1 rounds
+// written with vector operations.
+__attribute__((target("avx2")))
+void compressAVX2(uint32_t* state, const uint32_t* block) {
+    __m256i w[16];
+    for (int i = 0; i < 16; i++) {
+        w[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 8 * i));
+    }
+    __m256i s[5];
+    for (int i = 0; i < 5; i++) {
+        s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state + 8 * i));
+    }
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4];
+
+#pragma GCC unroll 80
+    for (int t = 0; t < 80; t++) {
+        if (t >= 16) {
+            __m256i x = _mm256_xor_si256(_mm256_xor_si256(w[(t + 13) & 15], w[(t + 8) & 15]),
+                                         _mm256_xor_si256(w[(t + 2) & 15], w[t & 15]));
+            w[t & 15] = rotl8(x, 1);
+        }
+        __m256i f;
+        if (t < 20) {
+            f = _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d)));
+        } else if (t < 40 || t >= 60) {
+            f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+        } else {
+            f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(d, _mm256_or_si256(b, c)));
+        }
+        __m256i temp = _mm256_add_epi32(_mm256_add_epi32(rotl8(a, 5), f),
+                                        _mm256_add_epi32(e, w[t & 15]));
+        temp = _mm256_add_epi32(temp, _mm256_set1_epi32(static_cast<int>(kRound[t / 20])));
+        e = d;
+        d = c;
+        c = rotl8(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    __m256i result[5] = {a, b, c, d, e};
+    for (int i = 0; i < 5; i++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(state + 8 * i),
+                            _mm256_add_epi32(s[i], result[i]));
+    }
+}
+
+// Sixteen messages at once. AVX-512 adds native rotates and three-input
+// logic, which covers each round function in one instruction.
+__attribute__((target("avx512f")))
+void compressAVX512(uint32_t* state, const uint32_t* block) {
+    __m512i w[16];
+    for (int i = 0; i < 16; i++) {
+        w[i] = _mm512_loadu_si512(block + 16 * i);
+    }
+    __m512i s[5];
+    for (int i = 0; i < 5; i++) {
+        s[i] = _mm512_loadu_si512(state + 16 * i);
+    }
+    __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4];
+
+#pragma GCC unroll 80
+    for (int t = 0; t < 80; t++) {
+        if (t >= 16) {
+            __m512i x = _mm512_ternarylogic_epi32(w[(t + 13) & 15], w[(t + 8) & 15],
+                                                  w[(t + 2) & 15], 0x96);
+            w[t & 15] = _mm512_rol_epi32(_mm512_xor_si512(x, w[t & 15]), 1);
+        }
+        __m512i f;
+        if (t < 20) {
+            f = _mm512_ternarylogic_epi32(b, c, d, 0xca);   // b ? c : d
+        } else if (t < 40 || t >= 60) {
+            f = _mm512_ternarylogic_epi32(b, c, d, 0x96);   // b ^ c ^ d
+        } else {
+            f = _mm512_ternarylogic_epi32(b, c, d, 0xe8);   // majority
+        }
+        __m512i temp = _mm512_add_epi32(_mm512_add_epi32(_mm512_rol_epi32(a, 5), f),
+                                        _mm512_add_epi32(e, w[t & 15]));
+        temp = _mm512_add_epi32(temp, _mm512_set1_epi32(static_cast<int>(kRound[t / 20])));
+        e = d;
+        d = c;
+        c = _mm512_rol_epi32(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    __m512i result[5] = {a, b, c, d, e};
+    for (int i = 0; i < 5; i++) {
+        _mm512_storeu_si512(state + 16 * i, _mm512_add_epi32(s[i], result[i]));
+    }
+}
+
+bool hasSHANI() {
+    return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+}
+
+bool hasAVX2() {
+    return __builtin_cpu_supports("avx2");
+}
+
+bool hasAVX512() {
+    return __builtin_cpu_supports("avx512f");
+}
+
+#endif
+
+// Slowest first on batches of small files; the last supported one is the
+// default
+const Kernel kKernels[] = {
+    {"scalar", 1, compressScalar, always},
+#ifdef GITHUB_MANAGER_SHA1_X86
+    {"shani", 1, compressSHANI, hasSHANI},
+    {"avx2", 8, compressAVX2, hasAVX2},
+    {"avx512", 16, compressAVX512, hasAVX512},
+#endif
+};
+
+const Kernel* findKernel(const std::string& name) {
+    for (const Kernel& kernel : kKernels) {
+        if (name == kernel.name && kernel.supported()) {
+            return &kernel;
+        }
+    }
+    return nullptr;
+}
+
+const Kernel* bestKernel() {
+    const char* forced = std::getenv("GITHUB_MANAGER_SHA1");
+    if (forced) {
+        const Kernel* kernel = findKernel(forced);
+        if (kernel) {
+            return kernel;
+        }
+    }
+
+    const Kernel* best = &kKernels[0];
+    for (const Kernel& kernel : kKernels) {
+        if (kernel.supported()) {
+            best = &kernel;
+        }
+    }
+    return best;
+}
+
+std::atomic<const Kernel*> selected{nullptr};
+
+const Kernel* activeKernel() {
+    const Kernel* kernel = selected.load(std::memory_order_acquire);
+    if (!kernel) {
+        kernel = bestKernel();
+        selected.store(kernel, std::memory_order_release);
+    }
+    return kernel;
+}
+
+size_t blockCount(const Sha1Job& job) {
+    // Message, the 0x80 marker and the 64-bit length, rounded up to blocks
+    return (job.prefixSize + job.size + 8) / 64 + 1;
+}
+
+// Stores block index of the padded message as 16 big-endian words, stride
+// words apart
+void loadBlock(const Sha1Job& job, size_t index, uint32_t* words, size_t stride) {
+    const unsigned char* prefix = static_cast<const unsigned char*>(job.prefix);
+    const unsigned char* data = static_cast<const unsigned char*>(job.data);
+    size_t total = job.prefixSize + job.size;
+    size_t offset = index * 64;
+
+    unsigned char padded[64];
+    const unsigned char* bytes;
+    if (offset >= job.prefixSize && offset + 64 <= total) {
+        bytes = data + (offset - job.prefixSize);
+    } else {
+        // First block (prefix) or the tail (padding and length)
+        for (size_t i = 0; i < 64; i++) {
+            size_t position = offset + i;
+            if (position < job.prefixSize) {
+                padded[i] = prefix[position];
+            } else if (position < total) {
+                padded[i] = data[position - job.prefixSize];
+            } else {
+                padded[i] = position == total ? 0x80 : 0;
+            }
+        }
+        if (index + 1 == blockCount(job)) {
+            uint64_t bits = static_cast<uint64_t>(total) * 8;
+            for (int i = 0; i < 8; i++) {
+                padded[63 - i] = static_cast<unsigned char>(bits >> (8 * i));
+            }
+        }
+        bytes = padded;
+    }
+
+    for (size_t i = 0; i < 16; i++) {
+        const unsigned char* p = bytes + 4 * i;
+        words[i * stride] = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                            (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+}
+
+}
+
+void sha1Batch(Sha1Job* jobs, size_t count) {
+    const Kernel* kernel = activeKernel();
+    const size_t lanes = kernel->lanes;
+
+    alignas(64) uint32_t state[5 * kMaxLanes] = {};
+    alignas(64) uint32_t block[16 * kMaxLanes] = {};
+
+    struct Lane {
+        Sha1Job* job = nullptr;
+        size_t next = 0;
+        size_t blocks = 0;
+    } lane[kMaxLanes];
+
+    size_t pending = 0;
+    size_t active = 0;
+    auto assign = [&](size_t i) {
+        lane[i] = Lane();
+        if (pending < count) {
+            lane[i].job = &jobs[pending++];
+            lane[i].blocks = blockCount(*lane[i].job);
+            for (size_t r = 0; r < 5; r++) {
+                state[r * lanes + i] = kInitial[r];
+            }
+            active++;
+        }
+    };
+    for (size_t i = 0; i < lanes; i++) {
+        assign(i);
+    }
+
+    while (active > 0) {
+        // Idle lanes hash whatever is left in their slots; the result is
+        // never read
+        for (size_t i = 0; i < lanes; i++) {
+            if (lane[i].job) {
+                loadBlock(*lane[i].job, lane[i].next, block + i, lanes);
+            }
+        }
+        kernel->compress(state, block);
+
+        for (size_t i = 0; i < lanes; i++) {
+            if (!lane[i].job || ++lane[i].next < lane[i].blocks) {
+                continue;
+            }
+            for (size_t r = 0; r < 5; r++) {
+                uint32_t word = state[r * lanes + i];
+                for (int k = 0; k < 4; k++) {
+                    lane[i].job->digest[4 * r + k] = static_cast<unsigned char>(word >> (24 - 8 * k));
+                }
+            }
+            active--;
+            assign(i);
+        }
+    }
+}
+
+const char* sha1KernelName() {
+    return activeKernel()->name;
+}
+
+std::vector<std::string> sha1Kernels() {
+    std::vector<std::string> names;
+    for (const Kernel& kernel : kKernels) {
+        if (kernel.supported()) {
+            names.push_back(kernel.name);
+        }
+    }
+    return names;
+}
+
+bool selectSha1Kernel(const std::string& name) {
+    const Kernel* kernel = findKernel(name);
+    if (!kernel) {
+        return false;
+    }
+    selected.store(kernel, std::memory_order_release);
+    return true;
+}
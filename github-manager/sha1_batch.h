@@ -0,0 +1,38 @@
+#ifndef GITHUB_MANAGER_SHA1_BATCH_H
+#define GITHUB_MANAGER_SHA1_BATCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// One message for sha1Batch: prefix followed by data, hashed as a single
+// message. The prefix saves copying small headers such as git's
+// "blob <size>\0" in front of the content.
+struct Sha1Job {
+    const void* prefix = nullptr;
+    size_t prefixSize = 0;
+    const void* data = nullptr;
+    size_t size = 0;
+    unsigned char digest[20];
+};
+
+// Hashes many independent messages in one call.
+//
+// The AVX2 and AVX-512 kernels are multi-buffer: they run 8 or 16 messages
+// side by side, one per vector lane, and hand a lane the next message as
+// soon as its current one is done, so messages of mixed sizes keep all
+// lanes busy. The SHA-NI kernel hashes one message at a time with the
+// dedicated instructions. The fastest kernel the CPU supports is used;
+// GITHUB_MANAGER_SHA1=<name> in the environment overrides the choice.
+void sha1Batch(Sha1Job* jobs, size_t count);
+
+// Name of the kernel in use ("scalar", "shani", "avx2", "avx512").
+const char* sha1KernelName();
+
+// Kernels usable on this CPU.
+std::vector<std::string> sha1Kernels();
+
+// Switches to the named kernel; false if it is unknown or unsupported.
+bool selectSha1Kernel(const std::string& name);
+
+#endif
@@ -0,0 +1,241 @@
+#include "upload_engine.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <thread>
+
+namespace {
+
+// Replays per job before a rate-limited request is reported as failed
+const int kMaxReplays = 5;
+
+}
+
+MultiUploadEngine::MultiUploadEngine(CurlHandlePool& _pool, struct curl_slist* _headers,
+                                     int _maxInFlight, const TransportOptions& _transport,
+                                     RateLimiter* _limiter, RetryPolicy* _retryPolicy)
+    : pool(_pool), headers(_headers), maxInFlight(_maxInFlight > 0 ? _maxInFlight : 1),
+      transport(_transport), limiter(_limiter), retryPolicy(_retryPolicy),
+      multi(curl_multi_init()) {
+    if (multi) {
+        applyTransportOptions(multi, transport);
+    }
+}
+
+MultiUploadEngine::~MultiUploadEngine() {
+    if (!multi) {
+        return;
+    }
+    // Detach transfers still running if run() bailed out early
+    for (const CurlHandlePool::Lease& lease : leases) {
+        CURL* handle = lease.get();
+        if (std::find(idle.begin(), idle.end(), handle) != idle.end()) {
+            continue;
+        }
+        char* privateData = nullptr;
+        curl_easy_getinfo(handle, CURLINFO_PRIVATE, &privateData);
+        curl_multi_remove_handle(multi, handle);
+        delete reinterpret_cast<Transfer*>(privateData);
+    }
+    curl_multi_cleanup(multi);
+}
+
+CURL* MultiUploadEngine::idleHandle() {
+    if (idle.empty()) {
+        CurlHandlePool::Lease lease = pool.acquire();
+        if (!lease) {
+            return nullptr;
+        }
+        CURL* handle = lease.get();
+        leases.push_back(std::move(lease));
+        return handle;
+    }
+
+    CURL* handle = idle.back();
+    idle.pop_back();
+    pool.reset(handle);
+    return handle;
+}
+
+void MultiUploadEngine::start(std::unique_ptr<Transfer> transfer) {
+    CURL* curl = transfer->handle;
+    const UploadJob& job = transfer->job;
+
+    curl_easy_setopt(curl, CURLOPT_URL, job.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    applyTransportOptions(curl, transport, job.url);
+    captureResponse(curl, transfer->response);
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, job.method.c_str());
+    if (job.bodySource) {
+        attachRequestBody(curl, *job.bodySource);
+    } else if (!job.body.empty()) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, job.body.data());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE,
+                         static_cast<curl_off_t>(job.body.size()));
+    }
+    // Ownership passes to the multi handle until finish() reclaims it
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+
+    curl_multi_add_handle(multi, curl);
+    transfer.release();
+    active++;
+}
+
+void MultiUploadEngine::finish(CURL* handle, CURLcode result,
+                               const CompletionHandler& onComplete) {
+    char* privateData = nullptr;
+    curl_easy_getinfo(handle, CURLINFO_PRIVATE, &privateData);
+    std::unique_ptr<Transfer> transfer(reinterpret_cast<Transfer*>(privateData));
+
+    completeResponse(handle, result, transfer->response);
+
+    curl_multi_remove_handle(multi, handle);
+    active--;
+
+    if (result == CURLE_OK) {
+        pool.recordTransfer(handle, transfer->response);
+        checkNegotiatedVersion(handle);
+    }
+    idle.push_back(handle);
+
+    UploadJob& job = transfer->job;
+    if (limiter && limiter->update(job.method, transfer->response) &&
+        job.attempts < kMaxReplays) {
+        job.attempts++;
+        job.notBefore = std::chrono::steady_clock::time_point();
+        replays.push_back(std::move(job));
+        return;
+    }
+
+    std::chrono::milliseconds delay(0);
+    if (retryPolicy &&
+        retryPolicy->shouldRetry(job.method, job.url, job.conditional, transfer->response,
+                                 job.failures + 1, delay)) {
+        job.failures++;
+        job.notBefore = std::chrono::steady_clock::now() + delay;
+        replays.push_back(std::move(job));
+        return;
+    }
+
+    onComplete(job, transfer->response);
+}
+
+std::unique_ptr<MultiUploadEngine::Transfer>
+MultiUploadEngine::nextTransfer(const JobSource& nextJob, std::chrono::milliseconds& wait) {
+    auto now = std::chrono::steady_clock::now();
+    auto transfer = std::make_unique<Transfer>();
+
+    for (auto it = replays.begin(); it != replays.end(); ++it) {
+        if (it->notBefore <= now) {
+            transfer->job = std::move(*it);
+            replays.erase(it);
+            return transfer;
+        }
+        auto due = std::chrono::ceil<std::chrono::milliseconds>(it->notBefore - now);
+        if (wait.count() <= 0 || due < wait) {
+            wait = due;
+        }
+    }
+
+    if (exhausted || !nextJob(transfer->job)) {
+        exhausted = true;
+        return nullptr;
+    }
+    return transfer;
+}
+
+void MultiUploadEngine::checkNegotiatedVersion(CURL* handle) {
+    if (!transport.http2 || versionChecked) {
+        return;
+    }
+    versionChecked = true;
+
+    long version = 0;
+    curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version);
+    if (version != CURL_HTTP_VERSION_2_0) {
+        std::cerr << "Server did not negotiate HTTP/2, falling back to HTTP/1.1" << std::endl;
+        allowParallelConnections(multi);
+    }
+}
+
+bool MultiUploadEngine::run(const JobSource& nextJob, const CompletionHandler& onComplete) {
+    if (!multi) {
+        std::cerr << "cURL error: failed to create multi handle" << std::endl;
+        return false;
+    }
+
+    exhausted = false;
+    while (true) {
+        // Keep the pipeline full, as far as the rate limiter allows
+        std::chrono::milliseconds wait(-1);
+        while (active < maxInFlight) {
+            if (!pending && !(pending = nextTransfer(nextJob, wait))) {
+                break;
+            }
+            if (limiter) {
+                wait = limiter->reserve(pending->job.method);
+                if (wait.count() > 0) {
+                    break;
+                }
+            }
+
+            // A streamed body starts from its first byte on every attempt
+            if (pending->job.bodySource && !pending->job.bodySource->rewind()) {
+                HttpResponse failed;
+                failed.result = CURLE_READ_ERROR;
+                onComplete(pending->job, failed);
+                pending.reset();
+                continue;
+            }
+
+            pending->handle = idleHandle();
+            if (!pending->handle) {
+                HttpResponse failed;
+                failed.result = CURLE_FAILED_INIT;
+                onComplete(pending->job, failed);
+                pending.reset();
+                continue;
+            }
+            start(std::move(pending));
+        }
+
+        if (active == 0) {
+            if (!pending && replays.empty()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::max(wait, std::chrono::milliseconds(1)));
+            continue;
+        }
+
+        int running = 0;
+        CURLMcode mc = curl_multi_perform(multi, &running);
+        if (mc != CURLM_OK) {
+            std::cerr << "cURL multi error: " << curl_multi_strerror(mc) << std::endl;
+            return false;
+        }
+
+        int queued = 0;
+        bool finishedAny = false;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+            if (msg->msg == CURLMSG_DONE) {
+                finish(msg->easy_handle, msg->data.result, onComplete);
+                finishedAny = true;
+            }
+        }
+
+        if (!finishedAny && running > 0) {
+            int timeoutMs = 1000;
+            if (wait.count() > 0 && wait.count() < timeoutMs) {
+                timeoutMs = static_cast<int>(wait.count());
+            }
+            mc = curl_multi_poll(multi, nullptr, 0, timeoutMs, nullptr);
+            if (mc != CURLM_OK) {
+                std::cerr << "cURL multi error: " << curl_multi_strerror(mc) << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,89 @@
+#ifndef GITHUB_MANAGER_UPLOAD_ENGINE_H
+#define GITHUB_MANAGER_UPLOAD_ENGINE_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include "curl_pool.h"
+#include "http_transport.h"
+#include "rate_limiter.h"
+#include "request_body.h"
+#include "retry_policy.h"
+
+// One request handed to the engine.
+struct UploadJob {
+    std::string label;   // remote path, used for progress output
+    std::string url;
+    std::string method = "PUT";
+    std::string body;
+    std::unique_ptr<RequestBody> bodySource;   // streamed instead of body if set
+    bool conditional = false;   // body carries the sha of the version it replaces
+    int attempts = 0;    // replays after rate limiting
+    int failures = 0;    // transient failures so far
+    std::chrono::steady_clock::time_point notBefore;   // backoff before a retry
+};
+
+// Event-driven upload engine built on curl_multi.
+//
+// Jobs are pulled lazily from a JobSource so only the requests that are
+// actually in flight are held in memory. Up to maxInFlight transfers run
+// concurrently from the calling thread; each finished transfer is handed to
+// the CompletionHandler in completion order. In HTTP/2 mode all transfers
+// share one multiplexed connection per host. With a RateLimiter attached,
+// transfers only start when the limiter allows it and requests rejected by
+// a rate limit are queued again instead of being reported as failures.
+// With a RetryPolicy, transient failures are queued again after their
+// backoff without holding up the other transfers.
+class MultiUploadEngine {
+public:
+    // Fills the job and returns true, or returns false when no jobs are left.
+    using JobSource = std::function<bool(UploadJob&)>;
+    using CompletionHandler = std::function<void(const UploadJob&, const HttpResponse&)>;
+
+    MultiUploadEngine(CurlHandlePool& pool, struct curl_slist* headers, int maxInFlight,
+                      const TransportOptions& transport = TransportOptions(),
+                      RateLimiter* limiter = nullptr, RetryPolicy* retryPolicy = nullptr);
+    MultiUploadEngine(const MultiUploadEngine&) = delete;
+    MultiUploadEngine& operator=(const MultiUploadEngine&) = delete;
+    ~MultiUploadEngine();
+
+    // Runs until the source is exhausted and every transfer has finished.
+    // Returns false if the multi interface itself failed.
+    bool run(const JobSource& nextJob, const CompletionHandler& onComplete);
+
+private:
+    struct Transfer {
+        UploadJob job;
+        HttpResponse response;
+        CURL* handle = nullptr;
+    };
+
+    // Next job to start, taking due replays first; null if nothing can start
+    // now. wait is set when the only candidates are replays still backing off.
+    std::unique_ptr<Transfer> nextTransfer(const JobSource& nextJob,
+                                           std::chrono::milliseconds& wait);
+    CURL* idleHandle();
+    void start(std::unique_ptr<Transfer> transfer);
+    void finish(CURL* handle, CURLcode result, const CompletionHandler& onComplete);
+    void checkNegotiatedVersion(CURL* handle);
+
+    CurlHandlePool& pool;
+    struct curl_slist* headers;
+    int maxInFlight;
+    TransportOptions transport;
+    RateLimiter* limiter;
+    RetryPolicy* retryPolicy;
+    bool versionChecked = false;
+    bool exhausted = false;
+    CURLM* multi;
+    std::vector<CurlHandlePool::Lease> leases;
+    std::vector<CURL*> idle;
+    std::deque<UploadJob> replays;
+    std::unique_ptr<Transfer> pending;
+    int active = 0;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "url_encode.h"
+
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#define GITHUB_MANAGER_URL_ENCODE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const char kHex[] = "0123456789ABCDEF";
+
+inline bool unreserved(unsigned char c, bool keepSlash) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '-' || c == '.' || c == '_' || c == '~' || (keepSlash && c == '/');
+}
+
+#ifdef GITHUB_MANAGER_URL_ENCODE_SSE2
+
+inline __m128i inRange(__m128i bytes, char low, char high) {
+    // Signed compares: bytes >= 0x80 are negative and never in range
+    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(static_cast<char>(low - 1))),
+                         _mm_cmplt_epi8(bytes, _mm_set1_epi8(static_cast<char>(high + 1))));
+}
+
+// Bit i is set when byte i of the 16 at input must be escaped
+inline unsigned escapeMask(const char* input, bool keepSlash) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    __m128i ok = _mm_or_si128(_mm_or_si128(inRange(bytes, 'a', 'z'), inRange(bytes, 'A', 'Z')),
+                              inRange(bytes, '0', '9'));
+    ok = _mm_or_si128(ok, inRange(bytes, '-', '.'));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('~')));
+    if (keepSlash) {
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('/')));
+    }
+    return ~static_cast<unsigned>(_mm_movemask_epi8(ok)) & 0xffff;
+}
+
+#endif
+
+}
+
+size_t percentEncodedSize(std::string_view value, bool keepSlash) {
+    const char* input = value.data();
+    size_t size = value.size();
+    size_t escaped = 0;
+    size_t at = 0;
+#ifdef GITHUB_MANAGER_URL_ENCODE_SSE2
+    for (; at + 16 <= size; at += 16) {
+        escaped += __builtin_popcount(escapeMask(input + at, keepSlash));
+    }
+#endif
+    for (; at < size; at++) {
+        escaped += !unreserved(static_cast<unsigned char>(input[at]), keepSlash);
+    }
+    return size + 2 * escaped;
+}
+
+char* percentEncode(std::string_view value, bool keepSlash, char* output) {
+    const char* input = value.data();
+    size_t size = value.size();
+    size_t at = 0;
+#ifdef GITHUB_MANAGER_URL_ENCODE_SSE2
+    for (; at + 16 <= size; at += 16) {
+        unsigned mask = escapeMask(input + at, keepSlash);
+        if (mask == 0) {
+            std::memcpy(output, input + at, 16);
+            output += 16;
+            continue;
+        }
+        // Copy the clean run before each escaped byte
+        size_t done = 0;
+        while (mask) {
+            size_t next = __builtin_ctz(mask);
+            std::memcpy(output, input + at + done, next - done);
+            output += next - done;
+            unsigned char c = static_cast<unsigned char>(input[at + next]);
+            *output++ = '%';
+            *output++ = kHex[c >> 4];
+            *output++ = kHex[c & 0x0f];
+            done = next + 1;
+            mask &= mask - 1;
+        }
+        std::memcpy(output, input + at + done, 16 - done);
+        output += 16 - done;
+    }
+#endif
+    for (; at < size; at++) {
+        unsigned char c = static_cast<unsigned char>(input[at]);
+        if (unreserved(c, keepSlash)) {
+            *output++ = static_cast<char>(c);
+        } else {
+            *output++ = '%';
+            *output++ = kHex[c >> 4];
+            *output++ = kHex[c & 0x0f];
+        }
+    }
+    return output;
+}
+
+std::string percentEncode(std::string_view value, bool keepSlash) {
+    std::string encoded(percentEncodedSize(value, keepSlash), '\0');
+    percentEncode(value, keepSlash, &encoded[0]);
+    return encoded;
+}
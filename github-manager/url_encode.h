@@ -0,0 +1,26 @@
+#ifndef GITHUB_MANAGER_URL_ENCODE_H
+#define GITHUB_MANAGER_URL_ENCODE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Percent-encoding (RFC 3986) of values placed into URL paths. Everything
+// except the unreserved characters A-Z a-z 0-9 - . _ ~ is written as %XX,
+// so spaces, '#', '?', '%' and non-ASCII names survive the trip. With
+// keepSlash, '/' is left alone so a repository path keeps its segments.
+//
+// Inputs are classified 16 bytes at a time with SSE2; runs of unreserved
+// bytes, which is nearly every path, are copied without looking at each
+// byte.
+
+// Exact number of characters percentEncode writes for value.
+size_t percentEncodedSize(std::string_view value, bool keepSlash);
+
+// Writes the encoding of value to output, which must have room for
+// percentEncodedSize(value, keepSlash) characters; returns the end.
+char* percentEncode(std::string_view value, bool keepSlash, char* output);
+
+std::string percentEncode(std::string_view value, bool keepSlash);
+
+#endif
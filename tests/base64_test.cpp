@@ -0,0 +1,202 @@
+// Base64Decoder and ContentsDecodeSink: every kernel usable on this CPU
+// must decode input wrapped every 60 characters (as the contents API
+// sends it), fed in pieces that split groups, with padded and unpadded
+// tails, to the same bytes as the scalar kernel, and must reject the same
+// invalid characters wherever they fall.
+//
+//   base64_test   (exit status 0 on success)
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "base64.h"
+#include "response_sink.h"
+
+namespace {
+
+int failures = 0;
+
+std::string sample(size_t size, unsigned seed) {
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<char>(((i + seed) * 2654435761u) >> 13);
+    }
+    return data;
+}
+
+// Encoded text with a newline after every 60 characters
+std::string wrapped(const std::string& data) {
+    std::string flat = base64Encode(data);
+    std::string text;
+    for (size_t at = 0; at < flat.size(); at += 60) {
+        text += flat.substr(at, 60);
+        text += '\n';
+    }
+    return text;
+}
+
+// Feeds text to a decoder in pieces of the given size; false if either
+// update or finish rejects it
+bool decodeInPieces(const std::string& text, size_t piece, std::string& output) {
+    Base64Decoder decoder;
+    output.clear();
+    std::vector<char> buffer(Base64Decoder::maxOutput(piece) + 2);
+    size_t written;
+    for (size_t at = 0; at < text.size(); at += piece) {
+        size_t size = std::min(piece, text.size() - at);
+        if (!decoder.update(text.data() + at, size, buffer.data(), written)) {
+            return false;
+        }
+        output.append(buffer.data(), written);
+    }
+    if (!decoder.finish(buffer.data(), written)) {
+        return false;
+    }
+    output.append(buffer.data(), written);
+    return true;
+}
+
+void check(bool condition, const std::string& kernel, const std::string& what) {
+    if (!condition) {
+        std::cerr << kernel << ": " << what << std::endl;
+        failures++;
+    }
+}
+
+// The outcomes the scalar kernel gives, for comparing the others against
+struct Reference {
+    std::vector<std::string> invalidDecodes;
+    std::vector<bool> invalidAccepted;
+};
+
+void testKernel(const std::string& kernel, Reference& reference, bool scalar) {
+    const size_t pieces[] = {1, 3, 5, 61, 64, 1000, 4096, 1 << 20};
+    for (size_t size : {0, 1, 2, 3, 4, 45, 46, 47, 48, 255, 4096, 65537, 200000}) {
+        std::string data = sample(size, static_cast<unsigned>(size));
+        std::string text = wrapped(data);
+        std::string flat = base64Encode(data);
+        std::string unpadded = flat.substr(0, flat.find('='));
+        std::string output;
+        for (size_t piece : pieces) {
+            std::string label = std::to_string(size) + " bytes in pieces of " + std::to_string(piece);
+            check(decodeInPieces(text, piece, output) && output == data, kernel,
+                  "wrapped input, " + label);
+            check(decodeInPieces(unpadded, piece, output) && output == data, kernel,
+                  "unpadded input, " + label);
+        }
+        check(base64Decode(text, output) && output == data, kernel,
+              "base64Decode, " + std::to_string(size) + " bytes");
+
+        // Encoding in pieces must match encoding all at once
+        Base64Encoder encoder;
+        std::string encoded;
+        std::vector<char> buffer(Base64Encoder::maxOutput(size) + 4);
+        for (size_t at = 0; at < size; at += 7) {
+            size_t piece = std::min<size_t>(7, size - at);
+            encoded.append(buffer.data(), encoder.update(data.data() + at, piece, buffer.data()));
+        }
+        encoded.append(buffer.data(), encoder.finish(buffer.data()));
+        check(encoded == flat, kernel, "encoding in pieces, " + std::to_string(size) + " bytes");
+    }
+
+    // Padding is optional, and so is part of it, as for unpadded input
+    std::string output;
+    for (const char* tail : {"QQ", "QQ=", "QQ==", "QQ==\n"}) {
+        check(decodeInPieces(tail, 1, output) && output == "A", kernel,
+              std::string("rejected \"") + tail + "\"");
+    }
+
+    // Tails that cannot end a stream, and text after the padding
+    for (const char* bad : {"Q", "QUJDR", "QQ==QQ==", "QUJD=", "Q===", "=QQ"}) {
+        check(!decodeInPieces(bad, 1, output) && !decodeInPieces(bad, 64, output), kernel,
+              std::string("accepted \"") + bad + "\"");
+    }
+
+    // An invalid character anywhere in a long input, including inside the
+    // blocks the vector kernels take at once
+    std::string text = wrapped(sample(3000, 7));
+    size_t index = 0;
+    for (size_t at = 0; at < text.size(); at += 37) {
+        for (char bad : {'-', '_', '*', '\x80', '\0', '.'}) {
+            std::string damaged = text;
+            damaged[at] = bad;
+            bool accepted = decodeInPieces(damaged, 4096, output);
+            if (scalar) {
+                reference.invalidAccepted.push_back(accepted);
+                reference.invalidDecodes.push_back(accepted ? output : "");
+            } else {
+                check(accepted == reference.invalidAccepted[index] &&
+                      (!accepted || output == reference.invalidDecodes[index]),
+                      kernel, "differs from scalar with '" + std::string(1, bad) + "' at " +
+                      std::to_string(at));
+            }
+            check(!accepted || text[at] == '\n', kernel,
+                  "accepted '" + std::string(1, bad) + "' at " + std::to_string(at));
+            index++;
+        }
+    }
+}
+
+// A contents API body, fed to ContentsDecodeSink in pieces of every size
+void testContentsSink(const std::string& kernel) {
+    std::string data = sample(10000, 3);
+    std::string escaped;
+    for (char c : wrapped(data)) {
+        escaped += c == '\n' ? std::string("\\n") : std::string(1, c);
+    }
+    std::string body = R"({"name":"f.bin","path":"d/f.bin","sha":"5ca1ab1e","size":10000,)"
+                       R"("encoding":"base64","content":")" + escaped +
+                       R"(","_links":{"self":"https://example/x"}})";
+    for (size_t piece : {1, 2, 7, 60, 61, 4096, 1 << 20}) {
+        std::string output;
+        StringSink target(output);
+        ContentsDecodeSink sink(target);
+        bool written = true;
+        for (size_t at = 0; at < body.size() && written; at += piece) {
+            written = sink.write(body.data() + at, std::min(piece, body.size() - at));
+        }
+        std::string label = "contents body in pieces of " + std::to_string(piece);
+        check(written && sink.finish(), kernel, label + " rejected");
+        check(output == data && sink.decodedSize() == static_cast<long long>(data.size()),
+              kernel, label + " decoded wrongly");
+        check(sink.metadata().find("\"sha\":\"5ca1ab1e\"") != std::string::npos &&
+              sink.metadata().find(escaped.substr(0, 60)) == std::string::npos,
+              kernel, label + " kept the wrong metadata");
+    }
+
+    std::string output;
+    StringSink target(output);
+    ContentsDecodeSink sink(target);
+    std::string bad = R"({"content":"QUJD*EVG\n","sha":"x"})";
+    check(!(sink.write(bad.data(), bad.size()) && sink.finish()), kernel,
+          "contents body with an invalid character accepted");
+}
+
+}
+
+int main() {
+    std::vector<std::string> kernels = base64Kernels();
+    if (kernels.empty() || kernels.front() != "scalar") {
+        std::cerr << "Expected the scalar kernel first" << std::endl;
+        return 1;
+    }
+    Reference reference;
+    for (const std::string& kernel : kernels) {
+        if (!selectBase64Kernel(kernel) || base64KernelName() != kernel) {
+            std::cerr << "Cannot select " << kernel << std::endl;
+            failures++;
+            continue;
+        }
+        testKernel(kernel, reference, kernel == "scalar");
+        testContentsSink(kernel);
+    }
+    check(!selectBase64Kernel("no-such-kernel"), "selectBase64Kernel", "accepted an unknown name");
+
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "base64_test: ok (" << kernels.size() << " kernels)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+// FileSource in mapped mode: reading past the point where consumed pages
+// are released, rewinding and reading again must give the same bytes and
+// must not touch memory outside the mapping.
+//
+//   file_source_test   (exit status 0 on success)
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "file_source.h"
+
+namespace {
+
+const size_t kFileSize = 24 * 1024 * 1024;    // three release steps
+const size_t kNeighbourSize = 32 * 1024 * 1024;
+const unsigned char kSentinel = 0xa5;
+
+unsigned char expected(size_t offset) {
+    return static_cast<unsigned char>((offset * 2654435761u) >> 13);
+}
+
+bool writeSample(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::string chunk(1024 * 1024, '\0');
+    bool written = true;
+    for (size_t at = 0; at < kFileSize && written; at += chunk.size()) {
+        for (size_t i = 0; i < chunk.size(); i++) {
+            chunk[i] = static_cast<char>(expected(at + i));
+        }
+        written = std::fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size();
+    }
+    return std::fclose(file) == 0 && written;
+}
+
+// Reads the whole file and checks every byte
+bool readAll(FileSource& source, const char* pass) {
+    const char* data;
+    size_t length;
+    size_t offset = 0;
+    while (source.next(data, length)) {
+        for (size_t i = 0; i < length; i++) {
+            if (static_cast<unsigned char>(data[i]) != expected(offset + i)) {
+                std::cerr << pass << ": wrong byte at offset " << offset + i << std::endl;
+                return false;
+            }
+        }
+        offset += length;
+    }
+    if (source.failed() || offset != kFileSize) {
+        std::cerr << pass << ": read " << offset << " of " << kFileSize << " bytes" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main() {
+    char path[] = "/tmp/file_source_test.XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd < 0) {
+        std::cerr << "Cannot create a temporary file: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    ::close(fd);
+    if (!writeSample(path)) {
+        std::cerr << "Cannot write " << path << std::endl;
+        ::unlink(path);
+        return 1;
+    }
+
+    bool ok = true;
+    {
+        FileSource source(path);
+        if (!source.isOpen() || !source.mapped()) {
+            std::cerr << "Expected a mapped source" << std::endl;
+            ::unlink(path);
+            return 1;
+        }
+
+        // Prime the mapping to learn its address, then place a sentinel
+        // region right below it, where a bad release would land
+        const char* base;
+        size_t length;
+        source.next(base, length);
+        char* neighbour = static_cast<char*>(::mmap(const_cast<char*>(base) - kNeighbourSize,
+                                                    kNeighbourSize, PROT_READ | PROT_WRITE,
+                                                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+                                                    -1, 0));
+        if (neighbour == MAP_FAILED || neighbour != base - kNeighbourSize) {
+            if (neighbour != MAP_FAILED) {
+                ::munmap(neighbour, kNeighbourSize);
+            }
+            neighbour = nullptr;
+            std::cerr << "Note: no room below the mapping; checking the data only" << std::endl;
+        } else {
+            std::memset(neighbour, kSentinel, kNeighbourSize);
+        }
+
+        ok = source.rewind() && readAll(source, "first pass") &&
+             source.rewind() && readAll(source, "after rewind") &&
+             source.rewind() && readAll(source, "after second rewind");
+
+        if (neighbour) {
+            for (size_t i = 0; i < kNeighbourSize; i++) {
+                if (static_cast<unsigned char>(neighbour[i]) != kSentinel) {
+                    std::cerr << "Memory " << kNeighbourSize - i
+                              << " bytes below the mapping was overwritten" << std::endl;
+                    ok = false;
+                    break;
+                }
+            }
+            ::munmap(neighbour, kNeighbourSize);
+        }
+    }
+
+    ::unlink(path);
+    if (ok) {
+        std::cout << "file_source_test: ok" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
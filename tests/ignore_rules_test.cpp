@@ -0,0 +1,235 @@
+// IgnoreRules against git's gitignore semantics (negation, trailing /,
+// anchoring, **, character classes, escapes), then DirectoryWalker on a
+// temporary tree for the precedence of nested .gitignore files,
+// .git/info/exclude and the --exclude patterns.
+//
+//   ignore_rules_test   (exit status 0 on success)
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include "dir_walker.h"
+#include "ignore_rules.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int failures = 0;
+
+const char* matchName(IgnoreRules::Match match) {
+    switch (match) {
+        case IgnoreRules::kIgnored: return "ignored";
+        case IgnoreRules::kIncluded: return "included";
+        default: return "no match";
+    }
+}
+
+// Checks path against rules parsed from text; directory is true for a
+// directory entry
+void expect(const char* text, const std::string& path, bool directory, IgnoreRules::Match expected) {
+    IgnoreRules rules;
+    rules.parse(text);
+    std::string name = path.substr(path.rfind('/') + 1);
+    IgnoreRules::Match match = rules.match(path, name, directory);
+    if (match != expected) {
+        std::cerr << "\"" << text << "\" on " << path << (directory ? "/" : "") << ": "
+                  << matchName(match) << ", expected " << matchName(expected) << std::endl;
+        failures++;
+    }
+}
+
+void ignored(const char* text, const std::string& path, bool directory = false) {
+    expect(text, path, directory, IgnoreRules::kIgnored);
+}
+
+void included(const char* text, const std::string& path, bool directory = false) {
+    expect(text, path, directory, IgnoreRules::kIncluded);
+}
+
+void unmatched(const char* text, const std::string& path, bool directory = false) {
+    expect(text, path, directory, IgnoreRules::kNone);
+}
+
+void testRules() {
+    // Comments and blank lines
+    unmatched("# build\n\n", "# build");
+    unmatched("# build\n\n", "build");
+
+    // Negation; the last matching pattern decides
+    ignored("*.log\n!keep.log", "a.log");
+    included("*.log\n!keep.log", "keep.log");
+    included("*.log\n!keep.log", "d/e/keep.log");
+    ignored("*.log\n!keep.log\nkeep.log", "keep.log");
+    included("build\n!build", "build", true);
+
+    // A trailing / matches directories only
+    ignored("build/", "build", true);
+    unmatched("build/", "build");
+    ignored("build/", "src/build", true);
+    ignored("*.d/", "x.d", true);
+    unmatched("*.d/", "x.d");
+
+    // A leading or inner / anchors the pattern to the file's directory
+    ignored("/root.txt", "root.txt");
+    unmatched("/root.txt", "d/root.txt");
+    ignored("doc/x.txt", "doc/x.txt");
+    unmatched("doc/x.txt", "a/doc/x.txt");
+    ignored("doc/*.txt", "doc/a.txt");
+    unmatched("doc/*.txt", "doc/sub/a.txt");
+    ignored("name", "a/b/name");
+    ignored("*.o", "a/b/c.o");
+
+    // * and ? stop at /, ** spans directories
+    ignored("?.c", "a.c");
+    unmatched("?.c", "ab.c");
+    ignored("**/foo", "foo");
+    ignored("**/foo", "a/b/foo");
+    ignored("a/**/b", "a/b");
+    ignored("a/**/b", "a/x/y/b");
+    unmatched("a/**/b", "x/a/b");
+    ignored("abc/**", "abc/x/y");
+    unmatched("abc/**", "abc", true);
+    ignored("d/**/*.c", "d/e/f/g.c");
+    unmatched("d*/x", "d/e/x");
+
+    // Character classes
+    ignored("[a-c].txt", "b.txt");
+    unmatched("[a-c].txt", "d.txt");
+    ignored("[!a]x", "bx");
+    unmatched("[!a]x", "ax");
+    ignored("[^a]x", "bx");
+    ignored("file[[:digit:]]", "file7");
+    unmatched("file[[:digit:]]", "filex");
+    ignored("[[:upper:]]*", "Makefile");
+    unmatched("[[:upper:]]*", "makefile");
+    ignored("x[]]y", "x]y");
+
+    // Escapes: \# and \! start literal names, \* and \? match themselves,
+    // and "\ " keeps a trailing space that would otherwise be trimmed
+    ignored("\\#hash", "#hash");
+    ignored("\\!bang", "!bang");
+    unmatched("\\!bang", "bang");
+    ignored("star\\*", "star*");
+    unmatched("star\\*", "starx");
+    ignored("what\\?", "what?");
+    unmatched("what\\?", "whatx");
+    ignored("trailing   ", "trailing");
+    ignored("space\\ ", "space ");
+    unmatched("space\\ ", "space");
+
+    if (!globMatch("a/**/z", "a/b/c/z") || globMatch("a/*/z", "a/b/c/z") ||
+        !globMatch("**", "x/y") || globMatch("[!x]", "x")) {
+        std::cerr << "globMatch disagrees with git's wildmatch" << std::endl;
+        failures++;
+    }
+}
+
+void writeFile(const fs::path& path, const std::string& text) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << text;
+}
+
+std::set<std::string> walk(const fs::path& root, const char* commandLine, const char* infoExclude,
+                           bool useGitignore) {
+    IgnoreRules command;
+    command.parse(commandLine);
+    IgnoreRules info;
+    info.parse(infoExclude);
+    DirectoryWalker walker(2);
+    walker.setExcludes(std::move(command), std::move(info), useGitignore);
+    FileList files;
+    std::set<std::string> paths;
+    if (!walker.walk(root.string(), files)) {
+        std::cerr << "Cannot walk " << root << std::endl;
+        failures++;
+        return paths;
+    }
+    for (size_t i = 0; i < files.size(); i++) {
+        paths.insert(std::string(files.path(i)));
+    }
+    return paths;
+}
+
+void expectFiles(const char* what, const std::set<std::string>& found,
+                 const std::set<std::string>& expected) {
+    if (found == expected) {
+        return;
+    }
+    std::cerr << what << ":" << std::endl;
+    for (const std::string& path : expected) {
+        if (!found.count(path)) {
+            std::cerr << "  missing " << path << std::endl;
+        }
+    }
+    for (const std::string& path : found) {
+        if (!expected.count(path)) {
+            std::cerr << "  unexpected " << path << std::endl;
+        }
+    }
+    failures++;
+}
+
+void testNested(const fs::path& top) {
+    // The root's parent ignores everything, which must not matter
+    writeFile(top / ".gitignore", "*\n");
+    fs::path root = top / "root";
+    writeFile(root / ".gitignore", "*.log\n/top-only.txt\nsub/anchored.txt\nbuild/\n!build/keep\n");
+    writeFile(root / "sub/.gitignore", "!keep.log\n*.tmp\n!info.dat\n");
+    writeFile(root / "sub/deep/.gitignore", "keep.log\n");
+    for (const char* path : {"a.log", "forced.log", "top-only.txt", "x.tmp", "info.dat", "cli.txt",
+                             "sub/top-only.txt", "sub/anchored.txt", "sub/keep.log", "sub/other.log",
+                             "sub/x.tmp", "sub/info.dat", "sub/deep/keep.log", "sub/deep/a.txt",
+                             "build/keep", "build/out.o"}) {
+        writeFile(root / path, "x");
+    }
+
+    // Deeper .gitignore files outrank their parents, any .gitignore
+    // outranks info/exclude, and the command line outranks them all
+    const char* commandLine = "!forced.log\ncli.txt\nsub/deep/a.txt\n";
+    const char* infoExclude = "info.dat\n";
+    expectFiles("nested precedence", walk(root, commandLine, infoExclude, true), {
+        ".gitignore", "forced.log", "x.tmp", "sub/.gitignore", "sub/top-only.txt",
+        "sub/keep.log", "sub/info.dat", "sub/deep/.gitignore",
+    });
+
+    // Without .gitignore files (main then skips info/exclude too) only the
+    // command line counts
+    expectFiles("without .gitignore", walk(root, commandLine, "", false), {
+        ".gitignore", "a.log", "forced.log", "top-only.txt", "x.tmp", "info.dat",
+        "sub/.gitignore", "sub/top-only.txt", "sub/anchored.txt", "sub/keep.log",
+        "sub/other.log", "sub/x.tmp", "sub/info.dat", "sub/deep/.gitignore",
+        "sub/deep/keep.log", "build/keep", "build/out.o",
+    });
+
+    // Walking a subdirectory reads only the .gitignore files from there on
+    expectFiles("walk of a subdirectory", walk(root / "sub", "", "", true), {
+        ".gitignore", "top-only.txt", "anchored.txt", "keep.log", "other.log", "info.dat",
+        "deep/.gitignore", "deep/a.txt",
+    });
+}
+
+}
+
+int main() {
+    testRules();
+
+    char pattern[] = "/tmp/ignore_rules_test.XXXXXX";
+    if (!::mkdtemp(pattern)) {
+        std::cerr << "Cannot create a temporary directory" << std::endl;
+        return 1;
+    }
+    testNested(pattern);
+    std::error_code ec;
+    fs::remove_all(pattern, ec);
+
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "ignore_rules_test: ok" << std::endl;
+    return 0;
+}
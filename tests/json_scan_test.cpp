@@ -0,0 +1,170 @@
+// jsonHasMember and jsonString: known answers for escapes, nesting,
+// repeated keys and ~0/~1 pointer segments, then every truncation and
+// single-byte corruption of a set of documents checked against a full
+// jsoncpp parse, which is the contract the scanner's fallback keeps.
+//
+//   json_scan_test   (exit status 0 on success)
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "json_scan.h"
+
+namespace {
+
+int failures = 0;
+
+void expectString(const std::string& text, const std::string& pointer, const char* expected) {
+    std::string value;
+    bool found = jsonString(text, pointer, value);
+    if (expected ? !found || value != expected : found) {
+        std::cerr << "jsonString(" << text << ", " << pointer << ") gave "
+                  << (found ? "\"" + value + "\"" : "nothing") << ", expected "
+                  << (expected ? "\"" + std::string(expected) + "\"" : "nothing") << std::endl;
+        failures++;
+    }
+}
+
+void expectMember(const std::string& text, const std::string& pointer, bool expected) {
+    if (jsonHasMember(text, pointer) != expected) {
+        std::cerr << "jsonHasMember(" << text << ", " << pointer << ") should be "
+                  << (expected ? "true" : "false") << std::endl;
+        failures++;
+    }
+}
+
+// The value at pointer according to jsoncpp, the reference
+bool reference(const std::string& text, const std::string& pointer, Json::Value& result) {
+    static Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    Json::Value root;
+    std::string errors;
+    if (!reader->parse(text.data(), text.data() + text.size(), &root, &errors)) {
+        return false;
+    }
+    const Json::Value* node = &root;
+    for (size_t at = 0; at < pointer.size();) {
+        size_t next = pointer.find('/', at + 1);
+        std::string raw = pointer.substr(at + 1, next == std::string::npos ? next : next - at - 1);
+        std::string segment;
+        for (size_t i = 0; i < raw.size(); i++) {
+            if (raw[i] == '~' && i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1')) {
+                segment += raw[++i] == '0' ? '~' : '/';
+            } else {
+                segment += raw[i];
+            }
+        }
+        if (node->isObject() && node->isMember(segment)) {
+            node = &(*node)[segment];
+        } else if (node->isArray() && !segment.empty() && segment.size() < 9 &&
+                   segment.find_first_not_of("0123456789") == std::string::npos &&
+                   std::stoul(segment) < node->size()) {
+            node = &(*node)[static_cast<Json::ArrayIndex>(std::stoul(segment))];
+        } else {
+            return false;
+        }
+        at = next;
+    }
+    result = *node;
+    return true;
+}
+
+void compareWithReference(const std::string& text, const std::string& pointer) {
+    Json::Value expected;
+    bool has = reference(text, pointer, expected);
+    std::string value;
+    bool isString = jsonString(text, pointer, value);
+    if (jsonHasMember(text, pointer) != has || isString != (has && expected.isString()) ||
+        (isString && value != expected.asString())) {
+        std::cerr << "Differs from jsoncpp at " << pointer << " in: " << text << std::endl;
+        failures++;
+    }
+}
+
+}
+
+int main() {
+    const std::string contents =
+        R"({"name":"a.txt","sha":"3b18e512","size":12,"content":"aGVsbG8g\nd29ybGQK\n",)"
+        R"("commit":{"sha":"c0ffee","tree":{"sha":"7ree"},"parents":[{"sha":"p1"},{"sha":"p2"}]},)"
+        R"("a/b":"slash","m~n":"tilde","empty":"","nothing":null,"flag":false})";
+
+    // Plain, nested and array paths
+    expectString(contents, "/sha", "3b18e512");
+    expectString(contents, "/commit/sha", "c0ffee");
+    expectString(contents, "/commit/tree/sha", "7ree");
+    expectString(contents, "/commit/parents/1/sha", "p2");
+    expectString(contents, "/commit/parents/2/sha", nullptr);
+    expectString(contents, "/content", "aGVsbG8g\nd29ybGQK\n");
+    expectString(contents, "/empty", "");
+    expectString(contents, "/size", nullptr);
+    expectMember(contents, "/size", true);
+    expectMember(contents, "/nothing", true);
+    expectMember(contents, "/flag", true);
+    expectMember(contents, "/missing", false);
+    expectMember(contents, "/sha/deeper", false);
+    expectMember(contents, "/commit/parents/x", false);
+
+    // ~1 is '/', ~0 is '~'
+    expectString(contents, "/a~1b", "slash");
+    expectString(contents, "/m~0n", "tilde");
+    expectMember(contents, "/a/b", false);
+
+    // Escapes in values are decoded; escaped keys still match
+    expectString(R"({"path":"dir\/f \"q\" \\ \u00e9"})", "/path", "dir/f \"q\" \\ \xc3\xa9");
+    expectString(R"({"s\u0068a":"x","a\/b":"y"})", "/sha", "x");
+    expectString(R"({"s\u0068a":"x","a\/b":"y"})", "/a~1b", "y");
+    expectString(R"({"emoji":"\ud83d\ude00"})", "/emoji", "\xf0\x9f\x98\x80");
+
+    // A repeated key: the last one wins, as in the full parser
+    expectString(R"({"sha":"first","sha":"second"})", "/sha", "second");
+    expectString(R"({"commit":{"sha":"a"},"commit":{"sha":"b"}})", "/commit/sha", "b");
+    expectString(R"({"commit":{"sha":"a"},"commit":{"tree":"t"}})", "/commit/sha", nullptr);
+
+    // Malformed or truncated text is never half answered
+    expectString(R"({"sha":"abc")", "/sha", nullptr);
+    expectString(R"({"sha":"abc","x":[1,2})", "/sha", nullptr);
+    expectString(R"({"sha":"abc","x":"unterminated})", "/sha", nullptr);
+    expectString(R"({"x":[1,}],"sha":"abc"})", "/sha", nullptr);
+    expectString(R"({"x":"\q","sha":"abc"})", "/sha", nullptr);
+    expectMember(R"({"x":tru,"sha":"abc"})", "/sha", false);
+
+    // Every truncation and a range of corruptions of these documents must
+    // get the same answers as jsoncpp
+    std::vector<std::string> documents = {
+        contents,
+        R"([{"path":"a","sha":"1"},{"path":"b","sha":"2"}])",
+        R"({"a":{"b":[true,false,null,-1.5e3,"s\"t"]},"a":{"b":[0]}})",
+        R"(  {"k\n":"v","sha":"x"}  )",
+        R"("scalar")",
+    };
+    const std::vector<std::string> pointers = {
+        "/sha", "/commit/sha", "/commit/parents/0/sha", "/0/sha", "/1/path", "/a/b/4",
+        "/a/b/0", "/k\n", "/a~1b", "/content", "",
+    };
+    const std::string corruptions = "{}[]\",:a1 \\";
+    size_t originals = documents.size();
+    for (size_t d = 0; d < originals; d++) {
+        const std::string document = documents[d];
+        for (size_t length = 0; length < document.size(); length++) {
+            documents.push_back(document.substr(0, length));
+            std::string damaged = document;
+            damaged[length] = corruptions[length % corruptions.size()];
+            documents.push_back(damaged);
+        }
+    }
+    for (const std::string& document : documents) {
+        for (const std::string& pointer : pointers) {
+            compareWithReference(document, pointer);
+        }
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "json_scan_test: ok" << std::endl;
+    return 0;
+}